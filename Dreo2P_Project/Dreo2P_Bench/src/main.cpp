@@ -0,0 +1,545 @@
+// Dreo2P Benchmark Application
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+
+#include "Writer.h"
+#include "Direct_Writer.h"
+#include "Binner.h"
+#include "Scan_Pattern.h"
+#include "Frame_Bus.h"
+#include "Alloc_Counter.h"
+#include "Raw_Recorder.h"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#define COMMIT_COMMAND "git rev-parse --short HEAD 2>nul"
+#else
+#define COMMIT_COMMAND "git rev-parse --short HEAD 2>/dev/null"
+#endif
+
+// Benchmark result (one number, machine readable)
+struct Bench_Result
+{
+	std::string	name;
+	double		value;
+	std::string	unit;
+};
+std::vector<Bench_Result> results;
+
+// Report a result (and keep it for the results file)
+void Record_Result(std::string name, double value, std::string unit)
+{
+	std::cout << name << ": " << value << " " << unit << "\n";
+	results.push_back({ name, value, unit });
+}
+
+// Current commit of the working tree ("unknown" outside a git checkout)
+std::string Commit_Id()
+{
+	std::string commit;
+	FILE* pipe = popen(COMMIT_COMMAND, "r");
+	if (pipe != NULL)
+	{
+		char line[64];
+		if (fgets(line, sizeof(line), pipe) != NULL)
+		{
+			commit = line;
+			commit.erase(commit.find_last_not_of(" \r\n") + 1);
+		}
+		pclose(pipe);
+	}
+	return commit.empty() ? "unknown" : commit;
+}
+
+// Save results as JSON (commit, then one object per result)
+void Save_Results(std::string path)
+{
+	std::ofstream file(path);
+	file << "{\n  \"commit\": \"" << Commit_Id() << "\",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		file << "    { \"name\": \"" << results[i].name << "\", \"value\": " << results[i].value << ", \"unit\": \"" << results[i].unit << "\" }";
+		file << ((i + 1 < results.size()) ? ",\n" : "\n");
+	}
+	file << "  ]\n}\n";
+}
+
+// Median time of a kernel (ns per call), after a warm up call
+double Time_Kernel(std::function<void()> kernel, int repeats)
+{
+	std::vector<double> times(repeats);
+	kernel();
+	for (int r = 0; r < repeats; r++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		kernel();
+		times[r] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	}
+	std::sort(times.begin(), times.end());
+	return times[repeats / 2];
+}
+
+// Size of a file (bytes)
+double File_Size(std::string path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	return file.is_open() ? (double)file.tellg() : 0.0;
+}
+
+// Write a stack of frames with the given options and report throughput (MB/s of saved channels) and compression ratio
+double Benchmark_Writer_Options(std::string path, int width, int height, int pages, Writer_Options options, double* ratio)
+{
+	// Fill test frames with a gradient (not compressible to nothing, not random)
+	int pixels = width * height;
+	std::vector<float> frames(2 * pixels);
+	for (int i = 0; i < pixels; i++)
+	{
+		frames[i] = (float)(i % width) / width;
+		frames[pixels + i] = (float)(i / width) / height;
+	}
+	for (int i = 0; i < pixels; i += 7)
+	{
+		frames[i] += 0.001f * (float)(i % 13);	// Some "noise"
+	}
+
+	// Start writer
+	auto start = std::chrono::steady_clock::now();
+	Writer writer(path, width, height, 2, pages, pages, options);
+
+	// Queue frames (wait for free slots, a benchmark should not drop frames)
+	for (int i = 0; i < pages; i++)
+	{
+		while (writer.Queue_Depth() >= options.queue_length)
+		{
+			std::this_thread::yield();
+		}
+		writer.Write_Frames(frames.data());
+	}
+
+	// Wait for all frames to reach the disk
+	writer.Close();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Measure and remove test files (one per channel, or a single stack)
+	double raw_bytes = (double)writer.Num_Saved_Channels() * pages * width * height * sizeof(float);
+	*ratio = raw_bytes / (File_Size(path + "_0.tiff") + File_Size(path + "_1.tiff") + File_Size(path + ".tiff"));
+	std::remove((path + "_0.tiff").c_str());
+	std::remove((path + "_1.tiff").c_str());
+	std::remove((path + ".tiff").c_str());
+
+	// Report throughput (uncompressed data rate)
+	return (raw_bytes / (1024.0 * 1024.0)) / seconds;
+}
+
+// Write a two channel stack of frames and report throughput (MB/s) and compression ratio
+double Benchmark_Writer(std::string path, int width, int height, int pages, Tiff_Format format, Tiff_Layout layout, Tiff_Compression compression, Tiff_Sample_Format sample_format, double* ratio)
+{
+	Writer_Options options;
+	options.format = format;
+	options.layout = layout;
+	options.compression = compression;
+	options.sample_format = sample_format;
+	return Benchmark_Writer_Options(path, width, height, pages, options, ratio);
+}
+
+// Stream a raw recording sized file (int16 chunks, as sent by the raw recorder) with direct I/O or buffered ofstream, report throughput (MB/s)
+double Benchmark_Direct_Writer(std::string path, long long total_bytes, int chunk_bytes, bool direct, Direct_Writer_Stats* stats)
+{
+	// Fill a chunk of "samples"
+	std::vector<short> chunk(chunk_bytes / sizeof(short));
+	for (int i = 0; i < (int)chunk.size(); i++)
+	{
+		chunk[i] = (short)((i * 37) % 4096);
+	}
+
+	// Write file
+	auto start = std::chrono::steady_clock::now();
+	if (direct)
+	{
+		Direct_Writer writer(path, total_bytes, 0);
+		for (long long written = 0; written < total_bytes; written += chunk_bytes)
+		{
+			writer.Append(chunk.data(), chunk_bytes);
+		}
+		writer.Close();
+		*stats = writer.Stats();
+	}
+	else
+	{
+		std::ofstream writer(path, std::ios::binary);
+		for (long long written = 0; written < total_bytes; written += chunk_bytes)
+		{
+			writer.write((const char*)chunk.data(), chunk_bytes);
+		}
+		writer.close();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::remove(path.c_str());
+
+	return ((double)total_bytes / (1024.0 * 1024.0)) / seconds;
+}
+
+// Time the acquisition hot paths for a square frame (standard scan: 5 MS/s input, 125 kpixels/s output)
+void Benchmark_Kernels(int size)
+{
+	std::string prefix = "kernel " + std::to_string(size) + "x" + std::to_string(size) + " ";
+
+	// Scan pattern generation (at Initialize) and its flyback interpolation
+	Record_Result(prefix + "generate_scan_waveform", Time_Kernel([&]() { Scan_Pattern pattern(4.9, 0.5, 5000000.0, 125000.0, size, size); }, 21) / 1000.0, "us");
+	std::vector<double> flyback(125);
+	Record_Result(prefix + "hermite_blend_interpolate", Time_Kernel([&]() { Scan_Pattern::Hermite_Blend_Interpolate(125, 5.5, -5.5, 0.02, 0.02, flyback.data()); }, 101), "ns");
+
+	// Scan lines of 4 channel samples (a gradient with some "noise"), 2 channel lines use the start
+	Scan_Pattern pattern(4.9, 0.5, 5000000.0, 125000.0, size, size);
+	std::vector<double> samples((size_t)pattern.samples_per_line_ * 4 * 16);
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		samples[i] = 0.001 * (double)(i % 1000) + 0.0001 * (double)((i * 7919) % 13);
+	}
+
+	// Binning (first frame of a group) and running averaging (later frames of a group of 8), per frame of lines, for 2 and 4 channels
+	for (int num_chans = 2; num_chans <= 4; num_chans += 2)
+	{
+		std::string chans = (num_chans == 2) ? "" : "_4ch";
+		for (int averages = 1; averages <= 8; averages *= 8)
+		{
+			Binner binner(size, size, pattern.pixels_per_line_, pattern.bin_factor_, averages, 0, num_chans);
+			double frame_time = Time_Kernel([&]()
+			{
+				for (int l = 0; l < size; l++)
+				{
+					binner.Bin_Line(&samples[(size_t)(l % 16) * pattern.samples_per_line_ * num_chans]);
+				}
+			}, 9);
+			double samples_per_second = ((double)size * pattern.samples_per_line_ * 1e9) / frame_time;
+			Record_Result(prefix + ((averages == 1) ? "bin_frame" : "average_frame") + chans, frame_time / 1000.0, "us");
+			Record_Result(prefix + ((averages == 1) ? "bin_rate" : "average_rate") + chans, samples_per_second / 1e6, "MS/s");
+		}
+	}
+
+	// Binning scaling with worker pool threads, per frame binned in blocks of 3 lines (what one 16 ms read holds at the standard scan), 2 and 4 channels
+	int thread_counts[4] = { 1, 2, 4, (int)std::thread::hardware_concurrency() };
+	for (int num_chans = 2; num_chans <= 4; num_chans += 2)
+	{
+		double single_time = 0.0;
+		for (int t = 0; t < 4; t++)
+		{
+			if ((t == 3) && (thread_counts[3] <= 4)) { break; }
+			Worker_Pool pool(thread_counts[t]);
+			Binner parallel_binner(size, size, pattern.pixels_per_line_, pattern.bin_factor_, 1, 0, num_chans);
+			double parallel_time = Time_Kernel([&]()
+			{
+				for (int l = 0; l < size; )
+				{
+					l += parallel_binner.Bin_Lines(samples.data(), std::min(3, size - l), &pool);
+				}
+			}, 9);
+			if (t == 0) { single_time = parallel_time; }
+			std::string name = prefix + "bin_frame_" + std::to_string(num_chans) + "ch_3_line_reads_" + std::to_string(thread_counts[t]) + "_threads";
+			Record_Result(name, parallel_time / 1000.0, "us");
+			Record_Result(name + " speedup", single_time / parallel_time, "x");
+		}
+	}
+
+	// Display copy (binned frame into the idle display buffer)
+	std::vector<float> frame((size_t)size * size, 0.5f);
+	std::vector<float> display_frame((size_t)size * size);
+	Record_Result(prefix + "display_copy", Time_Kernel([&]() { std::copy(frame.begin(), frame.end(), display_frame.begin()); }, 101) / 1000.0, "us");
+
+	// Saving (2 channel frames through the writer thread to a float32 stack, per frame)
+	int pages = std::max(8, (64 * 1024 * 1024) / (2 * size * size * (int)sizeof(float)));
+	double ratio;
+	double throughput = Benchmark_Writer_Options("Bench", size, size, pages, Writer_Options(), &ratio);
+	Record_Result(prefix + "save_frame", (2.0 * size * size * sizeof(float) * 1e6) / (throughput * 1024.0 * 1024.0), "us");
+}
+
+// Run back-to-back batches of different sizes on a worker pool (more threads than tasks, and the reverse), count tasks run other than exactly once
+long long Stress_Worker_Pool(int num_threads, int num_batches)
+{
+	Worker_Pool pool(num_threads);
+	long long errors = 0;
+	for (int b = 0; b < num_batches; b++)
+	{
+		// A new batch (and task) each time, so a task run from a finished batch is caught
+		int num_tasks = 1 + (b % 17);
+		std::vector<std::atomic<int>> runs(num_tasks);
+		for (int t = 0; t < num_tasks; t++) { runs[t] = 0; }
+		auto task = [&](int t)
+		{
+			if ((t < 0) || (t >= num_tasks)) { errors++; return; }
+			runs[t]++;
+		};
+		pool.Run(num_tasks, std::ref(task));
+		for (int t = 0; t < num_tasks; t++)
+		{
+			if (runs[t] != 1) { errors++; }
+		}
+	}
+	return errors;
+}
+
+// Record a raw sample file with a forced drop (and a second scan group), re-align lines as Dreo2P_Rebin does and count misplaced samples (each sample holds its position in a set of frames)
+long long Check_Recorder_Drops()
+{
+	// 1 channel, 100 samples per line, 4 lines per frame, 30 shifted samples (the ring holds 2000 scans)
+	Raw_Header header;
+	memset(&header, 0, sizeof(header));
+	header.num_chans = 1;
+	header.input_rate = 1000.0;
+	header.pixels_per_line = 25;
+	header.bin_factor = 4;
+	header.x_pixels = 20;
+	header.y_pixels = 4;
+	header.sample_shift = 30;
+	header.frames_to_average = 1;
+	long long samples_per_line = (long long)header.pixels_per_line * header.bin_factor;
+	long long set_scans = samples_per_line * header.y_pixels * header.frames_to_average;
+
+	// Acquire a scan group of 1000 scans, drop 2500 (more than the ring holds), acquire 2000 more, then a second scan group of 1000 scans
+	Raw_Recorder* recorder = new Raw_Recorder("Bench_Drops.raw", header, 10.0);
+	std::vector<short> chunk(2500);
+	int chunks[2][8] = { { 500, 500, 2500, 500, 500, 500, 500, 0 }, { 500, 500, 0 } };
+	long long total_acquired = 0;
+	for (int g = 0; g < 2; g++)
+	{
+		recorder->Start_Segment();
+		long long acquired = 0;
+		for (int c = 0; chunks[g][c] > 0; c++)
+		{
+			for (int s = 0; s < chunks[g][c]; s++)
+			{
+				chunk[s] = (short)((((acquired + s - header.sample_shift) % set_scans) + set_scans) % set_scans);
+			}
+			recorder->Record(chunk.data(), chunks[g][c]);
+			acquired += chunks[g][c];
+			total_acquired += chunks[g][c];
+
+			// Wait for the ring to empty (only the forced drop is lost)
+			while ((recorder->Scans_Recorded() + recorder->Scans_Dropped()) < total_acquired)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+	long long errors = (recorder->Scans_Dropped() != 2500) ? 1 : 0;
+	recorder->Close();
+	delete recorder;
+
+	// Re-align lines in each segment (a new scan group, or resumed after the drop) and check every sample of every line
+	std::ifstream raw_file("Bench_Drops.raw", std::ios::binary);
+	raw_file.read((char*)&header, sizeof(header));
+	std::vector<Raw_Segment> segments = Raw_Recorder::Read_Segments(raw_file, header);
+	if (header.num_segments != 3) { errors++; }
+	std::vector<short> line(samples_per_line);
+	long long frames = 0;
+	for (long long s = 0; s < header.num_segments; s++)
+	{
+		long long first_scan = Raw_Recorder::Aligned_Scan(segments[s], header.sample_shift, set_scans);
+		long long num_lines = std::max(0LL, (segments[s + 1].first_scan - first_scan) / samples_per_line);
+		raw_file.clear();
+		raw_file.seekg(raw_header_bytes + (first_scan * (long long)sizeof(short)));
+		for (long long l = 0; l < num_lines; l++)
+		{
+			raw_file.read((char*)line.data(), line.size() * sizeof(short));
+			for (long long i = 0; i < samples_per_line; i++)
+			{
+				if (line[i] != (short)(((l % header.y_pixels) * samples_per_line) + i)) { errors++; }
+			}
+		}
+		frames += num_lines / header.y_pixels;
+	}
+
+	// 2 frames before the drop, 4 after it, 2 in the second scan group
+	if (frames != 8) { errors++; }
+	raw_file.close();
+	std::remove("Bench_Drops.raw");
+	return errors;
+}
+
+// Count C++ heap allocations of the steady state acquisition path (binning, publishing and streaming 2 channel frames), there should be none
+long long Benchmark_Steady_State(int size)
+{
+	// Scan lines, binner, frame bus and a streaming writer (as the scanner thread sets them up)
+	Scan_Pattern pattern(4.9, 0.5, 5000000.0, 125000.0, size, size);
+	std::vector<double> samples((size_t)pattern.samples_per_line_ * 2 * 16, 0.01);
+	Binner binner(size, size, pattern.pixels_per_line_, pattern.bin_factor_, 1, 0, 2);
+	Writer_Options options;
+	Frame_Pool pool(size, size, 2, 8 + options.queue_length);
+	Frame_Bus bus(&pool);
+	int frames = 64;
+	Writer writer("Bench_Steady", size, size, 2, 0, frames, options);
+	bus.Subscribe([&](const Frame_Ref& frame) { writer.Write_Frame(&pool, frame); });
+
+	// Bin and publish frames (the first few warm up the writer and its files), counting the rest
+	for (int f = 0; f < frames; f++)
+	{
+		if (f == 4) { Alloc_Counter::Start(); }
+		for (int l = 0; l < size; l++)
+		{
+			binner.Bin_Line(&samples[(size_t)(l % 16) * pattern.samples_per_line_ * 2]);
+		}
+		while (writer.Queue_Depth() >= options.queue_length)
+		{
+			std::this_thread::yield();
+		}
+		bus.Publish(binner.frames_, (double)f);
+	}
+	while (writer.Queue_Depth() > 0)
+	{
+		std::this_thread::yield();
+	}
+	Alloc_Counter::Stop();
+
+	// Close and remove the stacks
+	writer.Close();
+	std::remove("Bench_Steady_0.tiff");
+	std::remove("Bench_Steady_1.tiff");
+	return Alloc_Counter::Count();
+}
+
+int main(int argc, char* argv[])
+{
+	std::cout << "Dreo2P::Benchmark\n";
+	std::cout << "-----------------\n";
+
+	// Arguments: Dreo2P_Bench [results.json] [kernels] (kernels = only the acquisition hot paths)
+	std::string results_path = (argc > 1) ? argv[1] : "Dreo2P_Bench.json";
+	bool kernels_only = (argc > 2) && (std::string(argv[2]) == "kernels");
+
+	// Frame sizes (standard and large) and formats to test
+	int sizes[2] = { 512, 2048 };
+	Tiff_Format formats[2] = { TIFF_FORMAT_CLASSIC, TIFF_FORMAT_BIG };
+	Tiff_Layout layouts[2] = { TIFF_LAYOUT_STRIPS, TIFF_LAYOUT_TILES };
+	const char* format_names[2] = { "classic", "bigtiff" };
+	const char* layout_names[2] = { "strips", "tiles" };
+	Tiff_Compression compressions[4] = { TIFF_COMPRESSION_NONE, TIFF_COMPRESSION_LZW, TIFF_COMPRESSION_DEFLATE, TIFF_COMPRESSION_ZSTD };
+	const char* compression_names[4] = { "none", "lzw", "deflate", "zstd" };
+	double ratio;
+
+	// Acquisition hot paths (standard and large frames)
+	for (int s = 0; s < 2; s++)
+	{
+		Benchmark_Kernels(sizes[s]);
+	}
+
+	// Worker pool batches (every task must run exactly once, fails the benchmark)
+	long long pool_errors = Stress_Worker_Pool(4, 20000) + Stress_Worker_Pool(32, 2000);
+	Record_Result("worker pool stress errors", (double)pool_errors, "tasks");
+	if (pool_errors > 0)
+	{
+		std::cout << "FAIL: worker pool ran a task other than once\n";
+		Save_Results(results_path);
+		return 1;
+	}
+
+	// Raw recording with dropped samples (re-binned lines must stay aligned, fails the benchmark)
+	long long drop_errors = Check_Recorder_Drops();
+	Record_Result("raw recorder drop errors", (double)drop_errors, "samples");
+	if (drop_errors > 0)
+	{
+		std::cout << "FAIL: raw recording misaligned after dropped samples\n";
+		Save_Results(results_path);
+		return 1;
+	}
+
+	// Steady state allocations (C++ must be none, fails the benchmark, C library allocations are only reported)
+	long long allocations = Benchmark_Steady_State(512);
+	Record_Result("steady state allocations", (double)allocations, "allocations");
+	if (Alloc_Counter::Counts_Malloc())
+	{
+		Record_Result("steady state C library allocations", (double)Alloc_Counter::Malloc_Count(), "allocations");
+	}
+	if (allocations > 0)
+	{
+		std::cout << "FAIL: the steady state acquisition path allocates\n";
+		Save_Results(results_path);
+		return 1;
+	}
+	if (kernels_only)
+	{
+		Save_Results(results_path);
+		return 0;
+	}
+
+	// TIFF write throughput (~512 MB per test)
+	for (int s = 0; s < 2; s++)
+	{
+		int pages = (512 * 1024 * 1024) / (2 * sizes[s] * sizes[s] * (int)sizeof(float));
+		for (int f = 0; f < 2; f++)
+		{
+			for (int l = 0; l < 2; l++)
+			{
+				double throughput = Benchmark_Writer("Bench", sizes[s], sizes[s], pages, formats[f], layouts[l], TIFF_COMPRESSION_NONE, TIFF_SAMPLE_FLOAT32, &ratio);
+				Record_Result("writer " + std::to_string(sizes[s]) + "x" + std::to_string(sizes[s]) + " " + format_names[f] + " " + layout_names[l], throughput, "MB/s");
+			}
+		}
+	}
+
+	// Compressed write throughput (standard frames, strips)
+	for (int c = 1; c < 4; c++)
+	{
+		int pages = (512 * 1024 * 1024) / (2 * 512 * 512 * (int)sizeof(float));
+		double throughput = Benchmark_Writer("Bench", 512, 512, pages, TIFF_FORMAT_AUTO, TIFF_LAYOUT_STRIPS, compressions[c], TIFF_SAMPLE_FLOAT32, &ratio);
+		Record_Result(std::string("writer 512x512 ") + compression_names[c], throughput, "MB/s");
+		Record_Result(std::string("writer 512x512 ") + compression_names[c] + " ratio", ratio, "x");
+	}
+
+	// 16-bit sample formats (throughput of the float32 input, ratio includes the 2x from narrowing)
+	Tiff_Sample_Format sample_formats[2] = { TIFF_SAMPLE_UINT16, TIFF_SAMPLE_FLOAT16 };
+	const char* sample_format_names[2] = { "uint16", "float16" };
+	for (int f = 0; f < 2; f++)
+	{
+		for (int c = 0; c < 3; c += 2)
+		{
+			int pages = (512 * 1024 * 1024) / (2 * 512 * 512 * (int)sizeof(float));
+			double throughput = Benchmark_Writer("Bench", 512, 512, pages, TIFF_FORMAT_AUTO, TIFF_LAYOUT_STRIPS, compressions[c], sample_formats[f], &ratio);
+			Record_Result(std::string("writer 512x512 ") + sample_format_names[f] + " " + compression_names[c], throughput, "MB/s");
+			Record_Result(std::string("writer 512x512 ") + sample_format_names[f] + " " + compression_names[c] + " ratio", ratio, "x");
+		}
+	}
+
+	// Channel layouts and selection (standard frames, time per frame includes every saved channel)
+	Tiff_Channel_Layout channel_layouts[3] = { TIFF_CHANNELS_SEPARATE, TIFF_CHANNELS_PAGES, TIFF_CHANNELS_PLANAR };
+	const char* channel_layout_names[3] = { "separate", "pages", "planar" };
+	for (int l = 0; l < 3; l++)
+	{
+		for (int mask = 3; mask > 0; mask -= 2)
+		{
+			int pages = (512 * 1024 * 1024) / (2 * 512 * 512 * (int)sizeof(float));
+			Writer_Options options;
+			options.channel_layout = channel_layouts[l];
+			options.channel_mask = mask;
+			double throughput = Benchmark_Writer_Options("Bench", 512, 512, pages, options, &ratio);
+			double frame_rate = (throughput * 1024.0 * 1024.0) / (((mask == 3) ? 2.0 : 1.0) * 512 * 512 * sizeof(float));
+			std::string name = std::string("writer 512x512 ") + channel_layout_names[l] + ((mask == 3) ? " 2ch" : " 1ch");
+			Record_Result(name, throughput, "MB/s");
+			Record_Result(name + " frame rate", frame_rate, "frames/s");
+		}
+	}
+
+	// Raw sample streaming (2 GB, 4 channels at 10 MS/s arrive in ~80 kB chunks every millisecond)
+	Direct_Writer_Stats stats;
+	double buffered = Benchmark_Direct_Writer("Bench.raw", 2048LL * 1024 * 1024, 80000, false, &stats);
+	Record_Result("raw stream buffered", buffered, "MB/s");
+	double direct = Benchmark_Direct_Writer("Bench.raw", 2048LL * 1024 * 1024, 80000, true, &stats);
+	Record_Result("raw stream direct", direct, "MB/s");
+	Record_Result("raw stream direct disk", stats.throughput, "MB/s");
+	const char* percentile_names[3] = { "p50", "p99", "p99.9" };
+	for (int p = 0; p < 3; p++)
+	{
+		Record_Result(std::string("raw stream direct submit latency ") + percentile_names[p], stats.submit_latency[p], "us");
+		Record_Result(std::string("raw stream direct completion latency ") + percentile_names[p], stats.complete_latency[p], "us");
+	}
+
+	// Save results (for tracking regressions per commit)
+	Save_Results(results_path);
+	return 0;
+}
@@ -2,14 +2,283 @@
 
 #include <iostream>
 #include <string>
+#include <cstdio>
 
 #include "Scanner.h"
+#include "Stack_Reader.h"
+#include "Simulated_Source.h"
+#include "Alloc_Counter.h"
 
-int main()
+// Replay a saved stack in the display window (frames are viewed in the mapped file, no loading)
+int Replay_Stack(char* path, double frame_rate)
+{
+	// Map stack (uses the cached page index, if any)
+	Stack_Reader reader(path);
+	Frame_View view = reader.Frame(0);
+	if (view.data == NULL)
+	{
+		std::cout << "Cannot map stack (must be an uncompressed TIFF): " << path << "\n";
+		return 1;
+	}
+	int num_frames = reader.Num_Frames();
+	std::cout << "Replaying " << num_frames << " frames (" << view.width << "x" << view.height << ")\n";
+
+	// Open display, scaled to the range of the first frame
+	Display display(view.width, view.height);
+	reader.Frame_To_Float(0, 0, display.frame_data_A_.data());
+	auto range = std::minmax_element(display.frame_data_A_.begin(), display.frame_data_A_.end());
+	display.min_ = *range.first;
+	display.max_ = *range.second;
+	display.use_A_ = true;
+
+	// Show frames (double buffered) at the requested rate
+	for (int f = 1; f < num_frames; f++)
+	{
+		std::vector<float>& next_frame = display.use_A_ ? display.frame_data_B_ : display.frame_data_A_;
+		if (reader.Frame_To_Float(f, 0, next_frame.data()))
+		{
+			display.use_A_ = !display.use_A_;
+		}
+		Sleep((DWORD)(1000.0 / frame_rate));
+	}
+
+	// Close display
+	display.Close();
+	return 0;
+}
+
+// Replay a raw sample recording through the full pipeline (binning, averaging, display and saving), reporting throughput
+int Replay_Raw(char* path, bool paced)
+{
+	// Construct scanner (scan parameters are taken from the recording)
+	Scanner scanner;
+	scanner.Configure_Replay(path, paced);
+	scanner.Configure_Streaming(true, 0.0);
+	scanner.Configure_Saving("Replay", 0);
+	scanner.Initialize(0.0, 0.0, 0.0, 0.0, 0, 0, 1, 0);
+	scanner.Configure_Display(0, -0.004f, 0.1f, false, false);
+
+	// Replay each recorded scan group (an empty group when the recording is finished)
+	int group = 0;
+	while (true)
+	{
+		scanner.Start();
+		scanner.Wait_For_Event(EVENT_STOPPED, -1.0);
+		double pixel_rate = scanner.Pixel_Rate();
+		if (pixel_rate <= 0.0) { break; }
+		std::cout << "Scan group " << group++ << ": " << (pixel_rate / 1000000.0) << " Mpixels/s\n";
+	}
+
+	// Close scanner
+	scanner.Close();
+	return 0;
+}
+
+// Scan a phantom (synthetic samples of a ground truth stack) through the full pipeline, saving frames and their ground truth
+int Scan_Phantom(char* path, bool paced)
+{
+	// Construct scanner
+	Scanner scanner;
+	int num_save = 10;
+	Phantom_Options options;
+	scanner.Configure_Phantom(path, options, paced);
+	scanner.Configure_Streaming(true, 0.0);
+	scanner.Configure_Saving("Phantom", num_save);
+	scanner.Initialize(4.9, 0.5, 5000000.0, 125000.0, 512, 512, 1, 100);
+	scanner.Configure_Display(0, -0.004f, 0.1f, false, false);
+
+	// Acquire frames (compare Phantom_*.tiff with Phantom_ground_truth_*.tiff)
+	scanner.Start();
+	scanner.Wait_For_Event(EVENT_STOPPED, -1.0);
+	std::cout << "Phantom: " << (scanner.Pixel_Rate() / 1000000.0) << " Mpixels/s\n";
+
+	// Close scanner
+	scanner.Close();
+	return 0;
+}
+
+// Run the pipeline (streaming every frame to disk) against a simulated device at increasing input rates and channel counts, report the maximum rate sustained without dropped samples or a growing backlog
+// (real-time: the scanner thread runs at real-time priority on CPU 1 with locked buffers, lines are binned on binning_threads threads)
+int Soak_Test(double seconds_per_rate, bool realtime, int binning_threads)
+{
+	// Channel counts and input rates (MS/s) to test, pixels at 125 kHz (bin factor grows with the input rate)
+	int channel_counts[3] = { 1, 2, 4 };	// The simulated device has up to 4 channels
+	double rates[8] = { 1.0, 2.0, 5.0, 10.0, 20.0, 40.0, 80.0, 160.0 };
+	for (int n = 0; n < 3; n++)
+	{
+		double max_sustained = 0.0;
+		for (int r = 0; r < 8; r++)
+		{
+			// Simulated device with a 1 second FIFO
+			double input_rate = rates[r] * 1000000.0;
+			Simulated_Source source(input_rate, channel_counts[n], 1.0);
+			Scanner scanner;
+			scanner.Configure_Source(&source);
+			if (realtime)
+			{
+				scanner.Configure_Thread(THREAD_SCANNER, PRIORITY_REALTIME, 1);
+				scanner.Configure_Memory_Lock(true);
+			}
+			scanner.Configure_Binning_Threads(binning_threads);
+			scanner.Configure_Streaming(true, 0.0);
+			scanner.Configure_Saving("Soak", 0);
+			scanner.Initialize(4.9, 0.5, input_rate, 125000.0, 512, 512, 1, 0);
+			scanner.Configure_Display(0, -0.5f, 0.5f, false, false);
+
+			// Scan (backlog peak measured separately in each half)
+			scanner.Start();
+			Sleep((DWORD)(500.0 * seconds_per_rate));
+			long long first_peak = source.Peak_Backlog();
+			source.Reset_Peak_Backlog();
+			Sleep((DWORD)(500.0 * seconds_per_rate));
+			long long second_peak = source.Peak_Backlog();
+			double scanner_cpu, display_cpu, binning_cpu, writer_cpu;
+			scanner.Thread_Cpu_Seconds(&scanner_cpu, &display_cpu);
+			scanner.Worker_Cpu_Seconds(&binning_cpu, &writer_cpu);
+			Stage_Stats wake = scanner.Stats().stages[STAGE_WAKE];
+			int tuning_failures = scanner.Tuning_Failures();
+			scanner.Stop();
+			scanner.Wait_For_Event(EVENT_STOPPED, -1.0);
+			scanner.Close();
+			for (int c = 0; c < channel_counts[n]; c++)
+			{
+				std::remove(("Soak_" + std::to_string(c) + ".tiff").c_str());
+			}
+
+			// Sustained? (nothing dropped, backlog not growing beyond 100 ms of jitter)
+			bool growing = second_peak > ((2 * first_peak) + (long long)(0.1 * input_rate));
+			bool sustained = (source.Scans_Dropped() == 0) && !growing;
+			std::cout << channel_counts[n] << " ch @ " << rates[r] << " MS/s: " << (sustained ? "ok" : "FAIL")
+				<< ", dropped " << source.Scans_Dropped() << " scans, peak backlog " << (1000.0 * second_peak / input_rate) << " ms"
+				<< ", CPU scanner " << (100.0 * scanner_cpu / seconds_per_rate) << "% binning workers " << (100.0 * binning_cpu / seconds_per_rate) << "% writer " << (100.0 * writer_cpu / seconds_per_rate) << "% display " << (100.0 * display_cpu / seconds_per_rate) << "%"
+				<< ", wake-up jitter p99 " << wake.p99 << " us max " << wake.max << " us"
+				<< ((tuning_failures > 0) ? " (real-time scheduling refused)" : "") << "\n";
+			if (!sustained) { break; }
+			max_sustained = rates[r];
+		}
+		std::cout << channel_counts[n] << " ch: maximum sustained input rate " << max_sustained << " MS/s\n";
+	}
+	return 0;
+}
+
+// Run several scanners at once, each reading its own simulated device (independent threads, buffers, windows and telemetry)
+int Multi_Scan(int num_scanners, double seconds)
+{
+	// Create scanners and their devices
+	std::vector<Simulated_Source*> sources;
+	std::vector<Scanner*> scanners;
+	for (int s = 0; s < num_scanners; s++)
+	{
+		sources.push_back(new Simulated_Source(5000000.0, 2, 1.0));
+		scanners.push_back(new Scanner());
+		scanners[s]->Configure_Source(sources[s]);
+		scanners[s]->Initialize(4.9, 0.5, 5000000.0, 125000.0, 512, 512, 1, 0);
+		scanners[s]->Configure_Display(0, -0.5f, 0.5f, false, false);
+	}
+
+	// Scan concurrently
+	for (int s = 0; s < num_scanners; s++)
+	{
+		scanners[s]->Start();
+	}
+	Sleep((DWORD)(1000.0 * seconds));
+	for (int s = 0; s < num_scanners; s++)
+	{
+		scanners[s]->Stop();
+	}
+
+	// Report and close
+	for (int s = 0; s < num_scanners; s++)
+	{
+		scanners[s]->Wait_For_Event(EVENT_STOPPED, -1.0);
+		std::cout << "Scanner " << s << ": " << (scanners[s]->Pixel_Rate() / 1000000.0) << " Mpixels/s, dropped " << sources[s]->Scans_Dropped() << " scans\n";
+		scanners[s]->Close();
+		delete scanners[s];
+		delete sources[s];
+	}
+	return 0;
+}
+
+// Stream from a simulated device and check that the steady state (after the first averaged frames) makes no C++ heap allocations
+int Allocation_Test(double seconds)
+{
+	// Scan, streaming every averaged frame to disk
+	Simulated_Source source(5000000.0, 2, 1.0);
+	Scanner scanner;
+	scanner.Configure_Source(&source);
+	scanner.Configure_Streaming(true, 0.0);
+	scanner.Configure_Saving("Allocation", 0);
+	scanner.Initialize(4.9, 0.5, 5000000.0, 125000.0, 512, 512, 1, 0);
+	scanner.Configure_Display(0, -0.5f, 0.5f, false, false);
+	scanner.Start();
+
+	// Warm up (first reads, frames and writes), then count
+	for (int i = 0; i < 4; i++)
+	{
+		scanner.Wait_For_Event(EVENT_GROUP, 5.0);
+	}
+	Alloc_Counter::Start();
+	Sleep((DWORD)(1000.0 * seconds));
+	Alloc_Counter::Stop();
+	scanner.Stop();
+	scanner.Wait_For_Event(EVENT_STOPPED, -1.0);
+	scanner.Close();
+
+	// Report (fails on any C++ allocation, C library allocations, e.g. by libtiff, are reported where they can be counted)
+	long long count = Alloc_Counter::Count();
+	std::cout << "Steady state: " << count << " C++ allocations (" << Alloc_Counter::Bytes() << " bytes) in " << seconds << " s: " << ((count == 0) ? "ok" : "FAIL") << "\n";
+	if (Alloc_Counter::Counts_Malloc())
+	{
+		std::cout << "C library: " << Alloc_Counter::Malloc_Count() << " allocations (" << Alloc_Counter::Malloc_Bytes() << " bytes)\n";
+	}
+	else
+	{
+		std::cout << "C library allocations not counted in this build\n";
+	}
+	return (count == 0) ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
 {
 	std::cout << "Dreo2P::Console Version\n";
 	std::cout << "-----------------------\n";
 
+	// Replay a saved stack? (Dreo2P_Console view <stack.tiff> [frames per second])
+	if ((argc > 2) && (std::string(argv[1]) == "view"))
+	{
+		return Replay_Stack(argv[2], (argc > 3) ? atof(argv[3]) : 30.0);
+	}
+
+	// Replay a raw recording? (Dreo2P_Console replay <raw file> [fast])
+	if ((argc > 2) && (std::string(argv[1]) == "replay"))
+	{
+		return Replay_Raw(argv[2], !((argc > 3) && (std::string(argv[3]) == "fast")));
+	}
+
+	// Soak test? (Dreo2P_Console soak [seconds per rate] [rt | normal] [binning threads, 0 = one per core])
+	if ((argc > 1) && (std::string(argv[1]) == "soak"))
+	{
+		return Soak_Test((argc > 2) ? atof(argv[2]) : 10.0, (argc > 3) && (std::string(argv[3]) == "rt"), (argc > 4) ? atoi(argv[4]) : 1);
+	}
+
+	// Scan a phantom? (Dreo2P_Console phantom <ground truth stack> [fast])
+	if ((argc > 2) && (std::string(argv[1]) == "phantom"))
+	{
+		return Scan_Phantom(argv[2], !((argc > 3) && (std::string(argv[3]) == "fast")));
+	}
+
+	// Several scanners? (Dreo2P_Console multi [scanners] [seconds])
+	if ((argc > 1) && (std::string(argv[1]) == "multi"))
+	{
+		return Multi_Scan((argc > 2) ? atoi(argv[2]) : 2, (argc > 3) ? atof(argv[3]) : 10.0);
+	}
+
+	// Allocation test? (Dreo2P_Console alloc [seconds])
+	if ((argc > 1) && (std::string(argv[1]) == "alloc"))
+	{
+		return Allocation_Test((argc > 2) ? atof(argv[2]) : 10.0);
+	}
+
 	// Construct scanner
 	Scanner scanner;
 	int num_save = 2;
@@ -23,12 +292,13 @@ int main()
 		scanner.Start();
 		scanner.Configure_Display(0, -0.004f, 0.1f, true, true);
 
-		// Wait until done
-		while (scanner.Is_Scanning())
+		// Wait until done (reporting each averaged frame)
+		while (!scanner.Wait_For_Event(EVENT_STOPPED, 0.0))
 		{
-			// Maybe configure display or such...
-			Sleep(32);
-
+			if (scanner.Wait_For_Event(EVENT_GROUP, 1.0))
+			{
+				std::cout << "Averaged frame " << scanner.Frame_Sequence() << " complete.\n";
+			}
 		}
 		// Pause between scan groups
 		Sleep(500);
@@ -1,8 +1,9 @@
 // Dreo2PDLL.cpp 
 // -------------------------------------------------------------------
 // - A dead simple, high-performance scan acqusition system
-// -- Assumes a NI PCI-6110 is installed as 'dev1': X is Ch0, Y is Ch1
-// -- Assumes a Shutter is TTL controlled via dev1/port0/line0
+// -- Assumes a NI PCI-6110 is installed as 'dev1': X is Ch0, Y is Ch1 (unless configured)
+// -- Assumes a Shutter is TTL controlled via dev1/port0/line0 (unless configured)
+// -- Functions without a handle use the default (global) scanner
 // -------------------------------------------------------------------
 // Author: Adam Kampff
 #include <math.h>
@@ -15,6 +16,9 @@
 // ---------------------
 Scanner scanner;
 
+// Frame callback: called on the scanner thread with each averaged frame (all channels, valid only during the call)
+typedef void (*Frame_Callback)(const Frame_Ref* frame, void* context);
+
 // ---------------------
 // Function Declarations
 // ---------------------
@@ -31,61 +35,359 @@ extern "C" __declspec(dllexport) void Initialize(
 	int num_to_save,
 	char* path);
 
+extern "C" __declspec(dllexport) void Configure_Streaming(int streaming, double duration);
+extern "C" __declspec(dllexport) void Configure_File_Format(int format, int layout);
+extern "C" __declspec(dllexport) void Configure_Compression(int compression, int threads);
+extern "C" __declspec(dllexport) int  Configure_Sample_Format(int format, double offset, double scale);
+extern "C" __declspec(dllexport) void Configure_Channels(int layout, int channel_mask);
+extern "C" __declspec(dllexport) void Configure_Raw_Recording(char* path, double duration);
+extern "C" __declspec(dllexport) void Configure_Pretrigger(char* path, double duration, char* trigger_line);
+extern "C" __declspec(dllexport) void Dump_Pretrigger();
+extern "C" __declspec(dllexport) void Configure_Replay(char* path, int paced);
+extern "C" __declspec(dllexport) void Configure_Phantom(char* path, double photon_rate, double mirror_lag, int paced);
+extern "C" __declspec(dllexport) double Get_Pixel_Rate();
+extern "C" __declspec(dllexport) void Get_Stats(Pipeline_Stats* stats);
+extern "C" __declspec(dllexport) void Reset_Stats();
+extern "C" __declspec(dllexport) void Configure_Trace(char* path, int events_per_thread);
+extern "C" __declspec(dllexport) void Configure_Thread(int thread, int priority, int cpu);
+extern "C" __declspec(dllexport) void Configure_Memory_Lock(int lock);
+extern "C" __declspec(dllexport) void Configure_Binning_Threads(int num_threads);
+extern "C" __declspec(dllexport) int  Get_Tuning_Failures();
+extern "C" __declspec(dllexport) void Configure_Telemetry(char* name);
+extern "C" __declspec(dllexport) void Configure_Frame_Ring(char* name, int num_slots);
+extern "C" __declspec(dllexport) int  Acquire_Frame(int channel, Frame_Lease* lease);
+extern "C" __declspec(dllexport) void Release_Frame(Frame_Lease* lease);
+extern "C" __declspec(dllexport) long long Get_Frame_Sequence();
+extern "C" __declspec(dllexport) void Register_Callback(Scan_Callback callback, void* context);
+extern "C" __declspec(dllexport) int  Wait_For_Event(int event, double timeout);
+extern "C" __declspec(dllexport) int  Subscribe_Frames(Frame_Callback callback, void* context);
+extern "C" __declspec(dllexport) void Unsubscribe_Frames(int subscription);
 extern "C" __declspec(dllexport) void Start();
 extern "C" __declspec(dllexport) void Configure_Display(int channel, float min, float max);
 extern "C" __declspec(dllexport) int  Is_Scanning();
 extern "C" __declspec(dllexport) void Stop();
 extern "C" __declspec(dllexport) void Close();
+extern "C" __declspec(dllexport) void Configure_Device(char* device, char* ai_channels, char* ao_channels, char* shutter_line);
+
+// Externals (handle API, one Scanner per handle)
+extern "C" __declspec(dllexport) Scanner* Create_Scanner();
+extern "C" __declspec(dllexport) void Destroy_Scanner(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Configure_Device(Scanner* handle, char* device, char* ai_channels, char* ao_channels, char* shutter_line);
+extern "C" __declspec(dllexport) void Scanner_Initialize(Scanner* handle, double amplitude, double y_offset, double input_rate, double output_rate, int x_pixels, int y_pixels, int averages, int sample_shift, int num_to_save, char* path);
+extern "C" __declspec(dllexport) void Scanner_Configure_Streaming(Scanner* handle, int streaming, double duration);
+extern "C" __declspec(dllexport) void Scanner_Configure_File_Format(Scanner* handle, int format, int layout);
+extern "C" __declspec(dllexport) void Scanner_Configure_Compression(Scanner* handle, int compression, int threads);
+extern "C" __declspec(dllexport) int Scanner_Configure_Sample_Format(Scanner* handle, int format, double offset, double scale);
+extern "C" __declspec(dllexport) void Scanner_Configure_Channels(Scanner* handle, int layout, int channel_mask);
+extern "C" __declspec(dllexport) void Scanner_Configure_Raw_Recording(Scanner* handle, char* path, double duration);
+extern "C" __declspec(dllexport) void Scanner_Configure_Pretrigger(Scanner* handle, char* path, double duration, char* trigger_line);
+extern "C" __declspec(dllexport) void Scanner_Dump_Pretrigger(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Configure_Replay(Scanner* handle, char* path, int paced);
+extern "C" __declspec(dllexport) void Scanner_Configure_Phantom(Scanner* handle, char* path, double photon_rate, double mirror_lag, int paced);
+extern "C" __declspec(dllexport) double Scanner_Get_Pixel_Rate(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Get_Stats(Scanner* handle, Pipeline_Stats* stats);
+extern "C" __declspec(dllexport) void Scanner_Reset_Stats(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Configure_Trace(Scanner* handle, char* path, int events_per_thread);
+extern "C" __declspec(dllexport) void Scanner_Configure_Thread(Scanner* handle, int thread, int priority, int cpu);
+extern "C" __declspec(dllexport) void Scanner_Configure_Memory_Lock(Scanner* handle, int lock);
+extern "C" __declspec(dllexport) void Scanner_Configure_Binning_Threads(Scanner* handle, int num_threads);
+extern "C" __declspec(dllexport) int Scanner_Get_Tuning_Failures(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Configure_Telemetry(Scanner* handle, char* name);
+extern "C" __declspec(dllexport) void Scanner_Configure_Frame_Ring(Scanner* handle, char* name, int num_slots);
+extern "C" __declspec(dllexport) int Scanner_Acquire_Frame(Scanner* handle, int channel, Frame_Lease* lease);
+extern "C" __declspec(dllexport) void Scanner_Release_Frame(Scanner* handle, Frame_Lease* lease);
+extern "C" __declspec(dllexport) long long Scanner_Get_Frame_Sequence(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Register_Callback(Scanner* handle, Scan_Callback callback, void* context);
+extern "C" __declspec(dllexport) int Scanner_Wait_For_Event(Scanner* handle, int event, double timeout);
+extern "C" __declspec(dllexport) int Scanner_Subscribe_Frames(Scanner* handle, Frame_Callback callback, void* context);
+extern "C" __declspec(dllexport) void Scanner_Unsubscribe_Frames(Scanner* handle, int subscription);
+extern "C" __declspec(dllexport) void Scanner_Start(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Configure_Display(Scanner* handle, int channel, float min, float max, int centre_cross, int scan_line);
+extern "C" __declspec(dllexport) int Scanner_Is_Scanning(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Stop(Scanner* handle);
+extern "C" __declspec(dllexport) void Scanner_Close(Scanner* handle);
 
 // Open a console for error reporting and associate stdin/stdout with it!
 // BOOL WINAPI AllocConsole(void);
 
 // ---------------------------------
-// External Function Definitions
+// Handle Function Definitions
 // ---------------------------------
 
+// Create scanner: an independent scanner (own threads, buffers and display window), configure its device before Initialize
+__declspec(dllexport) Scanner* Create_Scanner()
+{
+	// New scanner (the first live scanner keeps Dreo2P_Telemetry, others are named Dreo2P_Telemetry_<number>, the lowest free number)
+	return new Scanner();
+}
+
+// Destroy scanner
+__declspec(dllexport) void Destroy_Scanner(Scanner* handle)
+{
+	// Close (if initialized) and free the scanner
+	handle->Close();
+	delete handle;
+}
+
+// Configure device (call before Initialize): device name and channels relative to it, e.g. "Dev2", "ai0:1", "ao0:1", "port0/line0" (NULL = keep, empty shutter line = no shutter)
+__declspec(dllexport) void Scanner_Configure_Device(Scanner* handle, char* device, char* ai_channels, char* ao_channels, char* shutter_line)
+{
+	// Update device and channel names (each scanner needs its own device)
+	handle->Configure_Device(device, ai_channels, ao_channels, shutter_line);
+}
+
 // Initialize
-__declspec(dllexport) void Initialize(
+__declspec(dllexport) void Scanner_Initialize(
+		Scanner* handle,
 		double amplitude,
 		double y_offset,
-		double input_rate, 
-		double output_rate, 
-		int x_pixels, 
-		int y_pixels, 
+		double input_rate,
+		double output_rate,
+		int x_pixels,
+		int y_pixels,
 		int averages,
 		int sample_shift,
 		int num_to_save,
 		char* path)
 {
 	// Configure file saving location
-	scanner.Configure_Saving(path, num_to_save);
+	handle->Configure_Saving(path, num_to_save);
 
-	// Initialize global scnner object
-	scanner.Initialize(amplitude, y_offset, input_rate, output_rate, x_pixels, y_pixels, averages, sample_shift);
+	// Initialize scanner object
+	handle->Initialize(amplitude, y_offset, input_rate, output_rate, x_pixels, y_pixels, averages, sample_shift);
 	return;
 }
 
+// Configure streaming (call before Initialize): append every averaged frame while scanning continues
+__declspec(dllexport) void Scanner_Configure_Streaming(Scanner* handle, int streaming, double duration)
+{
+	// Update streaming parameters (num_to_save then limits the number of frames per Start, 0 = no limit)
+	bool stream = (streaming == 1) ? true : false;
+	handle->Configure_Streaming(stream, duration);
+}
+
+// Configure file format (call before Initialize): 0 = auto, 1 = classic, 2 = BigTIFF; layout: 0 = auto, 1 = strips, 2 = tiles
+__declspec(dllexport) void Scanner_Configure_File_Format(Scanner* handle, int format, int layout)
+{
+	// Update TIFF format and layout (auto selects BigTIFF for stacks beyond 4 GB and tiles for large frames)
+	handle->Configure_File_Format((Tiff_Format)format, (Tiff_Layout)layout);
+}
+
+// Configure compression (call before Initialize): 0 = none, 1 = LZW, 2 = deflate, 3 = zstd; threads: 0 = one per core
+__declspec(dllexport) void Scanner_Configure_Compression(Scanner* handle, int compression, int threads)
+{
+	// Update TIFF compression (lossless, with predictor)
+	handle->Configure_Compression((Tiff_Compression)compression, threads);
+}
+
+// Configure on-disk sample format (call before Initialize): 0 = float32, 1 = uint16 (volts = value * scale + offset), 2 = float16, returns 0 (format unchanged) for an unknown format or a zero or non-finite scale
+__declspec(dllexport) int Scanner_Configure_Sample_Format(Scanner* handle, int format, double offset, double scale)
+{
+	// Update sample format (calibration is stored in each page's image description)
+	return handle->Configure_Sample_Format((Tiff_Sample_Format)format, offset, scale) ? 1 : 0;
+}
+
+// Configure saved channels (call before Initialize): layout 0 = one file per channel, 1 = single file with a page per channel (ImageJ hyperstack), 2 = single file with planar pages; mask: bit per channel
+__declspec(dllexport) void Scanner_Configure_Channels(Scanner* handle, int layout, int channel_mask)
+{
+	// Update channel layout and selection (saving a single channel halves the data written per frame)
+	handle->Configure_Channels((Tiff_Channel_Layout)layout, channel_mask);
+}
+
+// Configure raw sample recording (call before Initialize): every int16 ADC sample is streamed to path (space preallocated for duration seconds)
+__declspec(dllexport) void Scanner_Configure_Raw_Recording(Scanner* handle, char* path, double duration)
+{
+	// Update raw recording (re-bin offline with Dreo2P_Rebin)
+	handle->Configure_Raw_Recording(path, duration);
+}
+
+// Configure pretrigger buffer (call before Initialize): keep the last duration seconds of averaged frames in memory, trigger_line: digital input that requests a dump ("" = none)
+__declspec(dllexport) void Scanner_Configure_Pretrigger(Scanner* handle, char* path, double duration, char* trigger_line)
+{
+	// Update pretrigger buffer (allocated at Initialize)
+	handle->Configure_Pretrigger(path, duration, trigger_line);
+}
+
+// Dump pretrigger buffer
+__declspec(dllexport) void Scanner_Dump_Pretrigger(Scanner* handle)
+{
+	// Write the buffered frames to a new stack (in the background, scanning continues)
+	handle->Dump_Pretrigger();
+}
+
+// Configure replay (call before Initialize): scan a raw sample recording instead of the device, paced = 1 at the recorded input rate, 0 = as fast as possible
+__declspec(dllexport) void Scanner_Configure_Replay(Scanner* handle, char* path, int paced)
+{
+	// Update replay (scan parameters are taken from the recording, each Start replays the next recorded scan group)
+	bool pace = (paced == 1) ? true : false;
+	handle->Configure_Replay(path, pace);
+}
+
+// Configure phantom (call before Initialize): scan a synthetic sample stream of a ground truth stack instead of the device (photons per sample at the brightest pixel, mirror lag in seconds), paced = 1 at the input rate, 0 = as fast as possible
+__declspec(dllexport) void Scanner_Configure_Phantom(Scanner* handle, char* path, double photon_rate, double mirror_lag, int paced)
+{
+	// Update phantom (other detector parameters keep their defaults, the ground truth frames are saved with the saved frames)
+	Phantom_Options options;
+	options.photon_rate = photon_rate;
+	options.mirror_lag = mirror_lag;
+	bool pace = (paced == 1) ? true : false;
+	handle->Configure_Phantom(path, options, pace);
+}
+
+// Get binned pixels per second
+__declspec(dllexport) double Scanner_Get_Pixel_Rate(Scanner* handle)
+{
+	// End-to-end throughput of the current (or last) scan group
+	return handle->Pixel_Rate();
+}
+
+// Get pipeline stage latencies: for each stage (read, bin, average, display copy, queue, write, upload, render, wake) count, mean, p50, p99, p99.9 and max in microseconds
+__declspec(dllexport) void Scanner_Get_Stats(Scanner* handle, Pipeline_Stats* stats)
+{
+	// Summarize the always-on histograms (the hot paths only count, the work is done here)
+	*stats = handle->Stats();
+}
+
+// Reset pipeline stage latencies
+__declspec(dllexport) void Scanner_Reset_Stats(Scanner* handle)
+{
+	// Start a new measurement
+	handle->Reset_Stats();
+}
+
+// Configure trace (call before Initialize): record reads, binning passes, frame publishes, texture uploads and disk writes, saved to path (Chrome trace JSON) on Close
+__declspec(dllexport) void Scanner_Configure_Trace(Scanner* handle, char* path, int events_per_thread)
+{
+	// Update trace (events_per_thread are preallocated for each thread, later events are dropped)
+	handle->Configure_Trace(path, events_per_thread);
+}
+
+// Configure thread (call before Initialize): priority (0 = normal, 1 = high, 2 = real-time) and CPU (-1 = any) of the scanner (0), display (1) or writer (2) thread
+__declspec(dllexport) void Scanner_Configure_Thread(Scanner* handle, int thread, int priority, int cpu)
+{
+	// Update scheduling (real-time priorities may need privileges, see Get_Tuning_Failures)
+	handle->Configure_Thread(thread, priority, cpu);
+}
+
+// Configure memory lock (call before Initialize): keep the acquisition buffers in physical memory (1) or pageable (0)
+__declspec(dllexport) void Scanner_Configure_Memory_Lock(Scanner* handle, int lock)
+{
+	// Update memory lock
+	handle->Configure_Memory_Lock(lock != 0);
+}
+
+// Configure binning threads (call before Initialize): bin blocks of scan lines on num_threads threads (1 = the scanner thread only, 0 = one per core)
+__declspec(dllexport) void Scanner_Configure_Binning_Threads(Scanner* handle, int num_threads)
+{
+	// Update binning (for high channel counts or sample rates)
+	handle->Configure_Binning_Threads(num_threads);
+}
+
+// Get tuning failures: number of thread priority, affinity and memory lock requests refused since Initialize
+__declspec(dllexport) int Scanner_Get_Tuning_Failures(Scanner* handle)
+{
+	// Check the scheduling was applied
+	return handle->Tuning_Failures();
+}
+
+// Configure telemetry (call before Initialize): name of the shared memory block with live counters (default "Dreo2P_Telemetry", "" = none), read with Dreo2P_Monitor
+__declspec(dllexport) void Scanner_Configure_Telemetry(Scanner* handle, char* name)
+{
+	// Update telemetry (published by the scanner thread, monitors never call into the DLL)
+	handle->Configure_Telemetry(name);
+}
+
+// Configure frame ring (call before Initialize): publish every averaged frame to a named shared memory ring of num_slots frames ("" = none), clients in other processes read frames in place (see Frame_Ring.h for the layout)
+__declspec(dllexport) void Scanner_Configure_Frame_Ring(Scanner* handle, char* name, int num_slots)
+{
+	// Update frame ring (clients that fall more than num_slots - 1 frames behind skip to the oldest frame)
+	handle->Configure_Frame_Ring(name, num_slots);
+}
+
+// Acquire frame: lease the latest averaged frame of a channel (pointer to width * height float32 pixels, sequence number and timestamp), returns 0 if no frame has been completed yet
+__declspec(dllexport) int Scanner_Acquire_Frame(Scanner* handle, int channel, Frame_Lease* lease)
+{
+	// Lease frame (read in place, the buffer is not reused until released, release every lease before Close)
+	if (handle->Acquire_Frame(channel, lease))
+	{
+		return 1;
+	}
+	else {
+		return 0;
+	}
+}
+
+// Release frame
+__declspec(dllexport) void Scanner_Release_Frame(Scanner* handle, Frame_Lease* lease)
+{
+	// Return the buffer to the pool
+	handle->Release_Frame(lease);
+}
+
+// Get sequence number of the latest averaged frame (-1 = none yet)
+__declspec(dllexport) long long Scanner_Get_Frame_Sequence(Scanner* handle)
+{
+	// Poll for new frames without taking a lease
+	return handle->Frame_Sequence();
+}
+
+// Register callback: called on the scanner thread for each event (0 = frame, 1 = averaged frame, 2 = scan group ended) with the event count and context, NULL = none
+__declspec(dllexport) void Scanner_Register_Callback(Scanner* handle, Scan_Callback callback, void* context)
+{
+	// Update callback (must return quickly, scanning waits for it)
+	handle->Register_Callback(callback, context);
+}
+
+// Wait for event: block until the next frame (0) or averaged frame (1), or until the scan group has ended (2), timeout in seconds (< 0 = none), returns 0 on timeout
+__declspec(dllexport) int Scanner_Wait_For_Event(Scanner* handle, int event, double timeout)
+{
+	// Wait (replaces polling Is_Scanning)
+	if ((event < 0) || (event >= num_scan_events)) { return 0; }
+	if (handle->Wait_For_Event((Scan_Event)event, timeout))
+	{
+		return 1;
+	}
+	else {
+		return 0;
+	}
+}
+
+// Subscribe frames: callback with every averaged frame (the shared pool buffer, not a copy), after Initialize, returns the subscription (-1 = not initialized)
+__declspec(dllexport) int Scanner_Subscribe_Frames(Scanner* handle, Frame_Callback callback, void* context)
+{
+	// Subscribe (must return quickly, scanning waits for it)
+	if (callback == NULL) { return -1; }
+	return handle->Subscribe_Frames([callback, context](const Frame_Ref& frame) { callback(&frame, context); });
+}
+
+// Unsubscribe frames: no further callbacks once this returns (may be called from the frame callback itself)
+__declspec(dllexport) void Scanner_Unsubscribe_Frames(Scanner* handle, int subscription)
+{
+	// Unsubscribe
+	handle->Unsubscribe_Frames(subscription);
+}
+
 // Start
-__declspec(dllexport) void Start()
+__declspec(dllexport) void Scanner_Start(Scanner* handle)
 {
 	// Start scanning (next average frame)
-	scanner.Start();
+	handle->Start();
 }
 
 // Configure display
-__declspec(dllexport) void Configure_Display(int channel, float min, float max, int centre_cross, int scan_line)
+__declspec(dllexport) void Scanner_Configure_Display(Scanner* handle, int channel, float min, float max, int centre_cross, int scan_line)
 {
 	// Update display parameters
 	bool centre = (centre_cross == 1) ? true : false;
 	bool scan = (scan_line == 1) ? true : false;
-	scanner.Configure_Display(channel, min, max, centre, scan);
+	handle->Configure_Display(channel, min, max, centre, scan);
 }
 
 // Check if the scanner is scanning
-__declspec(dllexport) int Is_Scanning()
+__declspec(dllexport) int Scanner_Is_Scanning(Scanner* handle)
 {
 	// Check scanning bool
-	if (scanner.Is_Scanning())
+	if (handle->Is_Scanning())
 	{
 		return 1;
 	}
@@ -95,22 +397,273 @@ __declspec(dllexport) int Is_Scanning()
 }
 
 // Stop
-__declspec(dllexport) void Stop()
+__declspec(dllexport) void Scanner_Stop(Scanner* handle)
 {
 	// Stop scanning (interrupt saving or stop a continuous acquisition)
-	scanner.Stop();
+	handle->Stop();
 }
 
-
 // Close
-__declspec(dllexport) void Close()
+__declspec(dllexport) void Scanner_Close(Scanner* handle)
 {
 	// Close the scanner
-	scanner.Close();
+	handle->Close();
 
 	return;
 }
 
+// ---------------------------------
+// External Function Definitions
+// ---------------------------------
+
+// Initialize
+__declspec(dllexport) void Initialize(
+		double amplitude,
+		double y_offset,
+		double input_rate, 
+		double output_rate, 
+		int x_pixels, 
+		int y_pixels, 
+		int averages,
+		int sample_shift,
+		int num_to_save,
+		char* path)
+{
+	// Default scanner
+	Scanner_Initialize(&scanner, amplitude, y_offset, input_rate, output_rate, x_pixels, y_pixels, averages, sample_shift, num_to_save, path);
+}
+
+// Configure streaming (call before Initialize): append every averaged frame while scanning continues
+__declspec(dllexport) void Configure_Streaming(int streaming, double duration)
+{
+	// Default scanner
+	Scanner_Configure_Streaming(&scanner, streaming, duration);
+}
+
+// Configure file format (call before Initialize): 0 = auto, 1 = classic, 2 = BigTIFF; layout: 0 = auto, 1 = strips, 2 = tiles
+__declspec(dllexport) void Configure_File_Format(int format, int layout)
+{
+	// Default scanner
+	Scanner_Configure_File_Format(&scanner, format, layout);
+}
+
+// Configure compression (call before Initialize): 0 = none, 1 = LZW, 2 = deflate, 3 = zstd; threads: 0 = one per core
+__declspec(dllexport) void Configure_Compression(int compression, int threads)
+{
+	// Default scanner
+	Scanner_Configure_Compression(&scanner, compression, threads);
+}
+
+// Configure on-disk sample format (call before Initialize): 0 = float32, 1 = uint16 (volts = value * scale + offset), 2 = float16, returns 0 (format unchanged) for an unknown format or a zero or non-finite scale
+__declspec(dllexport) int Configure_Sample_Format(int format, double offset, double scale)
+{
+	// Default scanner
+	return Scanner_Configure_Sample_Format(&scanner, format, offset, scale);
+}
+
+// Configure saved channels (call before Initialize): layout 0 = one file per channel, 1 = single file with a page per channel (ImageJ hyperstack), 2 = single file with planar pages; mask: bit per channel
+__declspec(dllexport) void Configure_Channels(int layout, int channel_mask)
+{
+	// Default scanner
+	Scanner_Configure_Channels(&scanner, layout, channel_mask);
+}
+
+// Configure raw sample recording (call before Initialize): every int16 ADC sample is streamed to path (space preallocated for duration seconds)
+__declspec(dllexport) void Configure_Raw_Recording(char* path, double duration)
+{
+	// Default scanner
+	Scanner_Configure_Raw_Recording(&scanner, path, duration);
+}
+
+// Configure pretrigger buffer (call before Initialize): keep the last duration seconds of averaged frames in memory, trigger_line: digital input that requests a dump ("" = none)
+__declspec(dllexport) void Configure_Pretrigger(char* path, double duration, char* trigger_line)
+{
+	// Default scanner
+	Scanner_Configure_Pretrigger(&scanner, path, duration, trigger_line);
+}
+
+// Dump pretrigger buffer
+__declspec(dllexport) void Dump_Pretrigger()
+{
+	// Default scanner
+	Scanner_Dump_Pretrigger(&scanner);
+}
+
+// Configure replay (call before Initialize): scan a raw sample recording instead of the device, paced = 1 at the recorded input rate, 0 = as fast as possible
+__declspec(dllexport) void Configure_Replay(char* path, int paced)
+{
+	// Default scanner
+	Scanner_Configure_Replay(&scanner, path, paced);
+}
+
+// Configure phantom (call before Initialize): scan a synthetic sample stream of a ground truth stack instead of the device (photons per sample at the brightest pixel, mirror lag in seconds), paced = 1 at the input rate, 0 = as fast as possible
+__declspec(dllexport) void Configure_Phantom(char* path, double photon_rate, double mirror_lag, int paced)
+{
+	// Default scanner
+	Scanner_Configure_Phantom(&scanner, path, photon_rate, mirror_lag, paced);
+}
+
+// Get binned pixels per second
+__declspec(dllexport) double Get_Pixel_Rate()
+{
+	// Default scanner
+	return Scanner_Get_Pixel_Rate(&scanner);
+}
+
+// Get pipeline stage latencies: for each stage (read, bin, average, display copy, queue, write, upload, render, wake) count, mean, p50, p99, p99.9 and max in microseconds
+__declspec(dllexport) void Get_Stats(Pipeline_Stats* stats)
+{
+	// Default scanner
+	Scanner_Get_Stats(&scanner, stats);
+}
+
+// Reset pipeline stage latencies
+__declspec(dllexport) void Reset_Stats()
+{
+	// Default scanner
+	Scanner_Reset_Stats(&scanner);
+}
+
+// Configure trace (call before Initialize): record reads, binning passes, frame publishes, texture uploads and disk writes, saved to path (Chrome trace JSON) on Close
+__declspec(dllexport) void Configure_Trace(char* path, int events_per_thread)
+{
+	// Default scanner
+	Scanner_Configure_Trace(&scanner, path, events_per_thread);
+}
+
+// Configure thread (call before Initialize): priority (0 = normal, 1 = high, 2 = real-time) and CPU (-1 = any) of the scanner (0), display (1) or writer (2) thread
+__declspec(dllexport) void Configure_Thread(int thread, int priority, int cpu)
+{
+	// Default scanner
+	Scanner_Configure_Thread(&scanner, thread, priority, cpu);
+}
+
+// Configure memory lock (call before Initialize): keep the acquisition buffers in physical memory (1) or pageable (0)
+__declspec(dllexport) void Configure_Memory_Lock(int lock)
+{
+	// Default scanner
+	Scanner_Configure_Memory_Lock(&scanner, lock);
+}
+
+// Configure binning threads (call before Initialize): bin blocks of scan lines on num_threads threads (1 = the scanner thread only, 0 = one per core)
+__declspec(dllexport) void Configure_Binning_Threads(int num_threads)
+{
+	// Default scanner
+	Scanner_Configure_Binning_Threads(&scanner, num_threads);
+}
+
+// Get tuning failures: number of thread priority, affinity and memory lock requests refused since Initialize
+__declspec(dllexport) int Get_Tuning_Failures()
+{
+	// Default scanner
+	return Scanner_Get_Tuning_Failures(&scanner);
+}
+
+// Configure telemetry (call before Initialize): name of the shared memory block with live counters (default "Dreo2P_Telemetry", "" = none), read with Dreo2P_Monitor
+__declspec(dllexport) void Configure_Telemetry(char* name)
+{
+	// Default scanner
+	Scanner_Configure_Telemetry(&scanner, name);
+}
+
+// Configure frame ring (call before Initialize): publish every averaged frame to a named shared memory ring of num_slots frames ("" = none), clients in other processes read frames in place (see Frame_Ring.h for the layout)
+__declspec(dllexport) void Configure_Frame_Ring(char* name, int num_slots)
+{
+	// Default scanner
+	Scanner_Configure_Frame_Ring(&scanner, name, num_slots);
+}
+
+// Acquire frame: lease the latest averaged frame of a channel (pointer to width * height float32 pixels, sequence number and timestamp), returns 0 if no frame has been completed yet
+__declspec(dllexport) int Acquire_Frame(int channel, Frame_Lease* lease)
+{
+	// Default scanner
+	return Scanner_Acquire_Frame(&scanner, channel, lease);
+}
+
+// Release frame
+__declspec(dllexport) void Release_Frame(Frame_Lease* lease)
+{
+	// Default scanner
+	Scanner_Release_Frame(&scanner, lease);
+}
+
+// Get sequence number of the latest averaged frame (-1 = none yet)
+__declspec(dllexport) long long Get_Frame_Sequence()
+{
+	// Default scanner
+	return Scanner_Get_Frame_Sequence(&scanner);
+}
+
+// Register callback: called on the scanner thread for each event (0 = frame, 1 = averaged frame, 2 = scan group ended) with the event count and context, NULL = none
+__declspec(dllexport) void Register_Callback(Scan_Callback callback, void* context)
+{
+	// Default scanner
+	Scanner_Register_Callback(&scanner, callback, context);
+}
+
+// Wait for event: block until the next frame (0) or averaged frame (1), or until the scan group has ended (2), timeout in seconds (< 0 = none), returns 0 on timeout
+__declspec(dllexport) int Wait_For_Event(int event, double timeout)
+{
+	// Default scanner
+	return Scanner_Wait_For_Event(&scanner, event, timeout);
+}
+
+// Subscribe frames: callback with every averaged frame (the shared pool buffer, not a copy), after Initialize, returns the subscription (-1 = not initialized)
+__declspec(dllexport) int Subscribe_Frames(Frame_Callback callback, void* context)
+{
+	// Default scanner
+	return Scanner_Subscribe_Frames(&scanner, callback, context);
+}
+
+// Unsubscribe frames: no further callbacks once this returns (may be called from the frame callback itself)
+__declspec(dllexport) void Unsubscribe_Frames(int subscription)
+{
+	// Default scanner
+	Scanner_Unsubscribe_Frames(&scanner, subscription);
+}
+
+// Start
+__declspec(dllexport) void Start()
+{
+	// Default scanner
+	Scanner_Start(&scanner);
+}
+
+// Configure display
+__declspec(dllexport) void Configure_Display(int channel, float min, float max, int centre_cross, int scan_line)
+{
+	// Default scanner
+	Scanner_Configure_Display(&scanner, channel, min, max, centre_cross, scan_line);
+}
+
+// Check if the scanner is scanning
+__declspec(dllexport) int Is_Scanning()
+{
+	// Default scanner
+	return Scanner_Is_Scanning(&scanner);
+}
+
+// Stop
+__declspec(dllexport) void Stop()
+{
+	// Default scanner
+	Scanner_Stop(&scanner);
+}
+
+// Close
+__declspec(dllexport) void Close()
+{
+	// Default scanner
+	Scanner_Close(&scanner);
+}
+
+// Configure device (call before Initialize): device name and channels relative to it, e.g. "Dev2", "ai0:1", "ao0:1", "port0/line0" (NULL = keep, empty shutter line = no shutter)
+__declspec(dllexport) void Configure_Device(char* device, char* ai_channels, char* ao_channels, char* shutter_line)
+{
+	// Default scanner
+	Scanner_Configure_Device(&scanner, device, ai_channels, ao_channels, shutter_line);
+}
+
 // ---------------------------------
 // Internal Function Definitions
 // ---------------------------------
@@ -0,0 +1,132 @@
+// Dreo2P Monitor Application (prints the live counters, or follows the frames, a running scanner publishes to shared memory)
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <thread>
+
+#include "Telemetry.h"
+#include "Frame_Ring.h"
+
+// Print the counters of a telemetry block
+int Monitor_Telemetry(std::string name)
+{
+	// Wait for the scanner to create the block
+	Telemetry* telemetry = new Telemetry(name, false);
+	while (!telemetry->Is_Open())
+	{
+		std::cout << "Waiting for " << name << "...\n";
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		delete telemetry;
+		telemetry = new Telemetry(name, false);
+	}
+
+	// Print the counters twice a second (until the scanner closes the block)
+	Telemetry_Counters counters;
+	double last_timestamp = -1.0;
+	int stale = 0;
+	std::cout << std::fixed << std::setprecision(1);
+	while (true)
+	{
+		if (!telemetry->Read(&counters))
+		{
+			std::cout << "Telemetry block version mismatch or not published.\n";
+			break;
+		}
+		if (counters.timestamp == last_timestamp)
+		{
+			// Counters stop changing between scan groups, but not while scanning (closed or hung)
+			if (counters.scanning && (++stale > 20)) { std::cout << "Scanner not publishing.\n"; break; }
+		}
+		else
+		{
+			stale = 0;
+			last_timestamp = counters.timestamp;
+			std::cout << "[" << counters.timestamp << " s] "
+				<< (counters.scanning ? "scanning " : "idle     ")
+				<< counters.frame_width << "x" << counters.frame_height << "x" << counters.frames_to_average
+				<< "  frames " << counters.frames_completed << " (" << counters.frame_rate << " Hz)"
+				<< "  groups " << counters.groups_completed
+				<< "  " << counters.pixel_rate / 1e6 << " Mpx/s"
+				<< "  backlog " << counters.backlog_scans
+				<< "  lines dropped " << counters.lines_dropped
+				<< "  raw dropped " << counters.raw_scans_dropped
+				<< "  disk queue " << counters.disk_queue_depth
+				<< "  written " << counters.frames_written
+				<< "  dropped " << counters.frames_dropped
+				<< "  write errors " << counters.write_errors << "\n";
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	}
+
+	// Close
+	telemetry->Close();
+	delete telemetry;
+	return 0;
+}
+
+// Follow the frames of a frame ring (in place, as an analysis client would), reporting frames skipped by falling behind
+int Follow_Frames(std::string name)
+{
+	// Wait for the scanner to create the ring
+	Frame_Ring* ring = new Frame_Ring(name);
+	while (!ring->Is_Open())
+	{
+		std::cout << "Waiting for " << name << "...\n";
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		delete ring;
+		ring = new Frame_Ring(name);
+	}
+
+	// Read every frame from the next one published
+	long long next = ring->Frames_Published();
+	long long skipped = 0;
+	Frame_Ring_View view;
+	std::cout << std::fixed << std::setprecision(4);
+	while (true)
+	{
+		// Wait for the frame
+		if (next >= ring->Frames_Published())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		// Fallen behind? (skip to the oldest frame still in the ring)
+		long long oldest = ring->Oldest_Sequence();
+		if (next < oldest)
+		{
+			skipped += oldest - next;
+			next = oldest;
+		}
+
+		// Process in place (mean of each channel), then check the writer did not reuse the slot meanwhile
+		if (!ring->Read(next, &view)) { continue; }
+		size_t pixels = (size_t)view.width * view.height;
+		double means[4] = { 0.0, 0.0, 0.0, 0.0 };
+		for (int c = 0; c < std::min(view.num_chans, 4); c++)
+		{
+			double sum = 0.0;
+			for (size_t i = 0; i < pixels; i++) { sum += view.data[c * pixels + i]; }
+			means[c] = sum / pixels;
+		}
+		if (!ring->Is_Valid(next)) { continue; }
+		std::cout << "[" << view.timestamp << " s] frame " << view.sequence << " (" << view.width << "x" << view.height << "x" << view.num_chans << ")"
+			<< "  mean ch0 " << means[0] << " ch1 " << means[1] << "  skipped " << skipped << "\n";
+		next++;
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	// Follow frames? (Dreo2P_Monitor frames <ring name>, as set with Configure_Frame_Ring)
+	if ((argc > 2) && (std::string(argv[1]) == "frames"))
+	{
+		return Follow_Frames(argv[2]);
+	}
+
+	// Print counters (Dreo2P_Monitor [telemetry name], as set with Configure_Telemetry)
+	return Monitor_Telemetry((argc > 1) ? argv[1] : "Dreo2P_Telemetry");
+}
@@ -0,0 +1,114 @@
+// Dreo2P Re-binning Application (re-bin a raw sample recording with a different shift, bin factor, phase or averaging)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+
+#include "Raw_Recorder.h"
+#include "Binner.h"
+#include "Writer.h"
+
+int main(int argc, char* argv[])
+{
+	std::cout << "Dreo2P::Rebin\n";
+	std::cout << "-------------\n";
+
+	// Check arguments
+	if (argc < 3)
+	{
+		std::cout << "Usage: Dreo2P_Rebin <raw file> <output path> [sample shift] [bin factor] [phase] [averages]\n";
+		return 1;
+	}
+
+	// Read header
+	std::ifstream raw_file(argv[1], std::ios::binary);
+	Raw_Header header;
+	raw_file.read((char*)&header, sizeof(header));
+	if (!raw_file || (strcmp(header.magic, "D2P_RAW") != 0))
+	{
+		std::cout << "Not a Dreo2P raw sample file: " << argv[1] << "\n";
+		return 1;
+	}
+	if ((header.num_chans < 1) || (header.num_chans > raw_max_chans))
+	{
+		std::cout << "Raw sample file has " << header.num_chans << " channels (1 to " << raw_max_chans << " supported): " << argv[1] << "\n";
+		return 1;
+	}
+
+	// Read segment table (stored after the samples)
+	std::vector<Raw_Segment> segments = Raw_Recorder::Read_Segments(raw_file, header);
+
+	// Re-binning parameters (default to those used live)
+	int samples_per_line = header.pixels_per_line * header.bin_factor;
+	int sample_shift = (argc > 3) ? atoi(argv[3]) : header.sample_shift;
+	int bin_factor = (argc > 4) ? atoi(argv[4]) : header.bin_factor;
+	int phase = (argc > 5) ? atoi(argv[5]) : 0;
+	int frames_to_average = (argc > 6) ? atoi(argv[6]) : header.frames_to_average;
+	if ((bin_factor < 1) || ((samples_per_line % bin_factor) != 0) || (frames_to_average < 1) || (sample_shift < 0))
+	{
+		std::cout << "Bin factor must divide the " << samples_per_line << " samples per line.\n";
+		return 1;
+	}
+
+	// Keep the same forward scan (in samples), expressed in new pixels
+	int pixels_per_line = samples_per_line / bin_factor;
+	int x_pixels = (header.x_pixels * header.bin_factor) / bin_factor;
+	int y_pixels = header.y_pixels;
+	std::cout << "Input: " << header.num_scans << " scans in " << header.num_segments << " segments\n";
+	std::cout << "Output: " << x_pixels << "x" << y_pixels << " pixels, shift " << sample_shift << ", bin " << bin_factor << ", phase " << phase << ", averages " << frames_to_average << "\n";
+
+	// Count averaged frames (full sets of averages in each segment, a segment after dropped samples starts at the next full set in its scan group)
+	long long set_scans = (long long)samples_per_line * y_pixels * frames_to_average;
+	int total_frames = 0;
+	for (int s = 0; s < header.num_segments; s++)
+	{
+		long long lines = (segments[s + 1].first_scan - Raw_Recorder::Aligned_Scan(segments[s], sample_shift, set_scans)) / samples_per_line;
+		if (lines > 0) { total_frames += (int)(lines / ((long long)y_pixels * frames_to_average)); }
+	}
+
+	// Start writer and binner
+	Writer_Options options;
+	Writer writer(argv[2], x_pixels, y_pixels, header.num_chans, total_frames, total_frames, options);
+	Binner binner(x_pixels, y_pixels, pixels_per_line, bin_factor, frames_to_average, phase, header.num_chans);
+
+	// Re-bin each segment
+	std::vector<short> raw_line(samples_per_line * header.num_chans);
+	std::vector<double> line(samples_per_line * header.num_chans);
+	int saved_frames = 0;
+	for (int s = 0; s < header.num_segments; s++)
+	{
+		// Skip the shifted samples at the start of the group (or, after dropped samples, to the next full set of averaged frames)
+		long long first_scan = Raw_Recorder::Aligned_Scan(segments[s], sample_shift, set_scans);
+		long long num_lines = std::max(0LL, (segments[s + 1].first_scan - first_scan) / samples_per_line);
+		raw_file.seekg(raw_header_bytes + (first_scan * header.num_chans * (long long)sizeof(short)));
+		binner.Reset();
+		for (long long l = 0; l < num_lines; l++)
+		{
+			// Read a scan line and scale to volts
+			raw_file.read((char*)raw_line.data(), raw_line.size() * sizeof(short));
+			Raw_Recorder::Scale_Samples(raw_line.data(), line.data(), samples_per_line, header.num_chans, header.scaling_coeffs);
+
+			// Bin, and save each full set of averages (wait for a free slot, offline we should not drop frames)
+			binner.Bin_Line(line.data());
+			if (binner.Group_Complete())
+			{
+				while (writer.Queue_Depth() >= options.queue_length)
+				{
+					std::this_thread::yield();
+				}
+				writer.Write_Frames(binner.frames_);
+				saved_frames++;
+			}
+		}
+	}
+
+	// Wait for all frames to reach the disk
+	writer.Close();
+	std::cout << "Saved " << saved_frames << " frames to " << argv[2] << "_<channel>.tiff (" << header.num_chans << " channels)\n";
+
+	return 0;
+}
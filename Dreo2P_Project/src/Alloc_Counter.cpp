@@ -0,0 +1,190 @@
+// Dreo2P Alloc Counter Class (source)
+#include "Alloc_Counter.h"
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#endif
+#ifdef __GLIBC__
+#include <cerrno>
+extern "C" void* __libc_malloc(size_t bytes);
+extern "C" void* __libc_calloc(size_t count, size_t bytes);
+extern "C" void* __libc_realloc(void* block, size_t bytes);
+extern "C" void* __libc_memalign(size_t alignment, size_t bytes);
+#endif
+
+// Counters
+std::atomic<bool>		Alloc_Counter::counting_ = false;
+std::atomic<long long>	Alloc_Counter::count_ = 0;
+std::atomic<long long>	Alloc_Counter::bytes_ = 0;
+std::atomic<long long>	Alloc_Counter::malloc_count_ = 0;
+std::atomic<long long>	Alloc_Counter::malloc_bytes_ = 0;
+
+// Count a C library allocation (if counting)
+static inline void Count_Malloc(size_t bytes)
+{
+	if (Alloc_Counter::counting_)
+	{
+		Alloc_Counter::malloc_count_++;
+		Alloc_Counter::malloc_bytes_ += (long long)bytes;
+	}
+}
+
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+// Debug CRT allocation hook (sees every CRT heap allocation, those made by operator new are counted there)
+static thread_local bool in_operator_new = false;
+static int Alloc_Hook(int type, void* block, size_t bytes, int block_use, long request, const unsigned char* file, int line)
+{
+	if (((type == _HOOK_ALLOC) || (type == _HOOK_REALLOC)) && !in_operator_new) { Count_Malloc(bytes); }
+	return 1;
+}
+#endif
+
+
+// Reset and start counting
+void Alloc_Counter::Start()
+{
+	count_ = 0;
+	bytes_ = 0;
+	malloc_count_ = 0;
+	malloc_bytes_ = 0;
+#if defined(_MSC_VER) && defined(_DEBUG)
+	_CrtSetAllocHook(Alloc_Hook);
+#endif
+	counting_ = true;
+}
+
+
+// Stop counting
+void Alloc_Counter::Stop()
+{
+	counting_ = false;
+}
+
+
+// C++ allocations counted
+long long Alloc_Counter::Count()
+{
+	return count_;
+}
+
+
+// Bytes allocated (C++) while counting
+long long Alloc_Counter::Bytes()
+{
+	return bytes_;
+}
+
+
+// C library allocations counted
+long long Alloc_Counter::Malloc_Count()
+{
+	return malloc_count_;
+}
+
+
+// Bytes allocated (C library) while counting
+long long Alloc_Counter::Malloc_Bytes()
+{
+	return malloc_bytes_;
+}
+
+
+// Are C library allocations counted?
+bool Alloc_Counter::Counts_Malloc()
+{
+#ifdef ALLOC_COUNTER_MALLOC
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+#ifdef __GLIBC__
+// C library allocations (replacing glibc's, which remain available as __libc_*)
+extern "C" void* malloc(size_t bytes)
+{
+	Count_Malloc(bytes);
+	return __libc_malloc(bytes);
+}
+
+extern "C" void* calloc(size_t count, size_t bytes)
+{
+	Count_Malloc(count * bytes);
+	return __libc_calloc(count, bytes);
+}
+
+extern "C" void* realloc(void* block, size_t bytes)
+{
+	Count_Malloc(bytes);
+	return __libc_realloc(block, bytes);
+}
+
+extern "C" void* memalign(size_t alignment, size_t bytes)
+{
+	Count_Malloc(bytes);
+	return __libc_memalign(alignment, bytes);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t bytes)
+{
+	Count_Malloc(bytes);
+	return __libc_memalign(alignment, bytes);
+}
+
+extern "C" int posix_memalign(void** block, size_t alignment, size_t bytes)
+{
+	Count_Malloc(bytes);
+	*block = __libc_memalign(alignment, bytes);
+	return (*block != NULL) ? 0 : ENOMEM;
+}
+#endif
+
+
+// Global operator new and delete (counted, otherwise the C library heap, without counting the block as a C allocation)
+void* operator new(size_t bytes)
+{
+	if (Alloc_Counter::counting_)
+	{
+		Alloc_Counter::count_++;
+		Alloc_Counter::bytes_ += (long long)bytes;
+	}
+#if defined(__GLIBC__)
+	void* block = __libc_malloc((bytes > 0) ? bytes : 1);
+#elif defined(_MSC_VER) && defined(_DEBUG)
+	in_operator_new = true;
+	void* block = malloc((bytes > 0) ? bytes : 1);
+	in_operator_new = false;
+#else
+	void* block = malloc((bytes > 0) ? bytes : 1);
+#endif
+	if (block == NULL) { throw std::bad_alloc(); }
+	return block;
+}
+
+void* operator new[](size_t bytes)
+{
+	return operator new(bytes);
+}
+
+void operator delete(void* block) noexcept
+{
+	free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+	free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+	free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept
+{
+	free(block);
+}
+
+// FIN
@@ -0,0 +1,34 @@
+// Dreo2P Alloc Counter Class (header)
+#pragma once
+// Include STD headers
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Where malloc can be counted too (libtiff, zlib and zstd allocate with malloc): the MSVC debug CRT (allocation hook) and glibc (malloc replaced in the executable)
+#if (defined(_MSC_VER) && defined(_DEBUG)) || defined(__GLIBC__)
+#define ALLOC_COUNTER_MALLOC
+#endif
+
+// Test hook: counts heap allocations (any thread) while counting, linking Alloc_Counter.cpp replaces the global operator new of the executable
+// - C++ allocations (operator new and new[]) are always counted
+// - C library allocations (malloc, calloc, realloc, aligned) are counted separately, only where ALLOC_COUNTER_MALLOC is defined (elsewhere, e.g. an MSVC release build, they are not seen)
+class Alloc_Counter
+{
+public:
+	// Public Methods
+	static void			Start();		// Reset and count
+	static void			Stop();
+	static long long	Count();		// C++ allocations made while counting
+	static long long	Bytes();
+	static long long	Malloc_Count();	// C library allocations made while counting (0 if not counted)
+	static long long	Malloc_Bytes();
+	static bool			Counts_Malloc();	// Are C library allocations counted?
+
+	// Public Members (updated by operator new, and malloc if counted)
+	static std::atomic<bool>		counting_;
+	static std::atomic<long long>	count_;
+	static std::atomic<long long>	bytes_;
+	static std::atomic<long long>	malloc_count_;
+	static std::atomic<long long>	malloc_bytes_;
+};
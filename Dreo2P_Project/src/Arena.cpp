@@ -0,0 +1,126 @@
+// Dreo2P Arena Class (source)
+#include "Arena.h"
+
+// Constructor
+Arena::Arena(size_t capacity)
+{
+	// Round up to whole huge pages (large arenas) or cache lines
+	capacity_ = (capacity >= arena_huge_page_bytes) ? ((capacity + arena_huge_page_bytes - 1) / arena_huge_page_bytes) * arena_huge_page_bytes : Footprint(capacity);
+	if (capacity_ == 0) { return; }
+
+#ifdef _WIN32
+	// Try large pages (needs the "Lock pages in memory" privilege), otherwise normal pages
+	SIZE_T large_page = GetLargePageMinimum();
+	if ((large_page > 0) && (capacity_ >= arena_huge_page_bytes))
+	{
+		SIZE_T large_bytes = ((capacity_ + large_page - 1) / large_page) * large_page;
+		base_ = (char*)VirtualAlloc(NULL, large_bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (base_ != NULL)
+		{
+			capacity_ = large_bytes;
+			huge_pages_ = true;
+		}
+	}
+	if (base_ == NULL)
+	{
+		base_ = (char*)VirtualAlloc(NULL, capacity_, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	}
+#else
+	// Align to a huge page and ask for transparent huge pages
+	void* block = NULL;
+	size_t alignment = (capacity_ >= arena_huge_page_bytes) ? arena_huge_page_bytes : arena_line_bytes;
+	if (posix_memalign(&block, alignment, capacity_) == 0)
+	{
+		base_ = (char*)block;
+		huge_pages_ = (alignment == arena_huge_page_bytes) && (madvise(base_, capacity_, MADV_HUGEPAGE) == 0);
+	}
+#endif
+	if (base_ == NULL)
+	{
+		capacity_ = 0;
+		return;
+	}
+
+	// Touch every page now (so scanning never waits on a page fault)
+	memset(base_, 0, capacity_);
+}
+
+
+// Destructor
+Arena::~Arena()
+{
+	if (base_ == NULL) { return; }
+#ifdef _WIN32
+	if (locked_) { VirtualUnlock(base_, capacity_); }
+	VirtualFree(base_, 0, MEM_RELEASE);
+#else
+	if (locked_) { munlock(base_, capacity_); }
+	free(base_);
+#endif
+}
+
+
+// Carve a buffer from the arena
+void* Arena::Allocate(size_t bytes)
+{
+	size_t footprint = Footprint(bytes);
+	if ((base_ == NULL) || (used_ + footprint > capacity_)) { return NULL; }
+	void* buffer = base_ + used_;
+	used_ += footprint;
+	return buffer;
+}
+
+
+// Bytes rounded up to whole cache lines
+size_t Arena::Footprint(size_t bytes)
+{
+	return ((bytes + arena_line_bytes - 1) / arena_line_bytes) * arena_line_bytes;
+}
+
+
+// Bytes allocated
+size_t Arena::Bytes_Used()
+{
+	return used_;
+}
+
+
+// Bytes available in total
+size_t Arena::Capacity()
+{
+	return capacity_;
+}
+
+
+// Lock the arena in physical memory (large pages are never paged)
+bool Arena::Lock()
+{
+	if (base_ == NULL) { return false; }
+	if (locked_) { return true; }
+#ifdef _WIN32
+	// Grow the working set to hold the arena, then lock it
+	SIZE_T min_bytes, max_bytes;
+	if (!GetProcessWorkingSetSize(GetCurrentProcess(), &min_bytes, &max_bytes)) { return false; }
+	if (!SetProcessWorkingSetSize(GetCurrentProcess(), min_bytes + capacity_, max_bytes + capacity_)) { return false; }
+	locked_ = (VirtualLock(base_, capacity_) != 0);
+#else
+	locked_ = (mlock(base_, capacity_) == 0);
+#endif
+	return locked_;
+}
+
+
+// Locked in physical memory?
+bool Arena::Locked()
+{
+	return locked_;
+}
+
+
+// Large (huge) pages?
+bool Arena::Huge_Pages()
+{
+	return huge_pages_;
+}
+
+// FIN
@@ -0,0 +1,45 @@
+// Dreo2P Arena Class (header)
+#pragma once
+// Include STD headers
+#include <cstddef>
+#include <cstring>
+
+// Include platform headers (large pages on Windows, transparent huge pages on Linux)
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <stdlib.h>
+#include <sys/mman.h>
+#endif
+
+// Allocations start on a cache line, the arena itself on a (huge) page
+static const size_t	arena_line_bytes = 64;
+static const size_t	arena_huge_page_bytes = 2 * 1024 * 1024;
+
+// One aligned block, carved into the buffers of a scan configuration (allocated and touched once, nothing is freed until the arena is deleted)
+class Arena
+{
+public:
+	// Constructors
+	Arena(size_t capacity);
+
+	// Destructors
+	~Arena();
+
+	// Public Methods
+	void*		Allocate(size_t bytes);					// Cache line aligned and zeroed (NULL if the arena is full)
+	static size_t	Footprint(size_t bytes);			// Arena bytes taken by an allocation (to size an arena)
+	size_t		Bytes_Used();
+	size_t		Capacity();
+	bool		Huge_Pages();							// Backed by large (huge) pages
+	bool		Lock();									// Keep resident (not pageable) until deleted (false if refused, e.g. over the locked memory limit)
+	bool		Locked();
+
+private:
+	// Private Members
+	char*		base_ = NULL;
+	size_t		capacity_ = 0;
+	size_t		used_ = 0;
+	bool		huge_pages_ = false;
+	bool		locked_ = false;
+};
@@ -0,0 +1,207 @@
+// Dreo2P Binner Class (source)
+#include "Binner.h"
+#include <algorithm>
+
+// Constructor
+Binner::Binner(int x_pixels, int y_pixels, int pixels_per_line, int bin_factor, int frames_to_average, int phase, int num_chans, float* frames)
+{
+	// Set scan geometry
+	x_pixels_ = x_pixels;
+	y_pixels_ = y_pixels;
+	pixels_per_line_ = pixels_per_line;
+	bin_factor_ = bin_factor;
+	frames_to_average_ = frames_to_average;
+	phase_ = std::min(std::max(phase, 0), pixels_per_line_ - x_pixels_);
+	num_chans_ = std::min(std::max(num_chans, 1), binner_max_chans);
+
+	// Make space for frames (all channels), unless given
+	if (frames != NULL)
+	{
+		frames_ = frames;
+	}
+	else
+	{
+		own_frames_.resize((size_t)x_pixels_ * y_pixels_ * num_chans_);
+		frames_ = own_frames_.data();
+	}
+}
+
+
+// Destructor
+Binner::~Binner()
+{
+}
+
+
+// Restart at the first line of the first frame (of a new scan group)
+void Binner::Reset()
+{
+	current_line_ = 0;
+	current_frame_ = 0;
+}
+
+
+// Bin subsequent samples of a scan line into pixel values and store the running average (ignoring flyback)
+void Binner::Bin_Line(const double* samples)
+{
+	// Bin line
+	Next_Line();
+	Bin_Row(samples, current_line_, 0, x_pixels_);
+
+	// Increment scan line indicator
+	current_line_++;
+}
+
+
+// Bin a block of scan lines (pixels of one frame are independent, so blocks of rows, or of columns, are binned in parallel and the frame is complete, in order, when this returns)
+int Binner::Bin_Lines(const double* samples, int num_lines, Worker_Pool* pool)
+{
+	// Lines left in the current frame
+	if (num_lines <= 0) { return 0; }
+	Next_Line();
+	int first_line = current_line_;
+	int lines = std::min(num_lines, y_pixels_ - first_line);
+	size_t line_samples = (size_t)pixels_per_line_ * bin_factor_ * num_chans_;
+
+	// Split by the samples to bin (a read holds only a few long lines), at most one task per thread
+	long long work = (long long)lines * x_pixels_ * bin_factor_ * num_chans_;
+	int tasks = (pool != NULL) ? (int)std::min((long long)pool->Num_Threads(), work / binner_min_task_samples) : 1;
+	tasks = std::max(tasks, 1);
+
+	// Static partition: contiguous blocks of rows, or (fewer lines than tasks) blocks of columns of every row
+	int row_blocks = std::min(lines, tasks);
+	int column_blocks = std::min(x_pixels_, tasks / row_blocks);
+	auto bin_block = [&](int block)
+	{
+		int row_block = block / column_blocks;
+		int column_block = block % column_blocks;
+		int first_column = (int)(((long long)column_block * x_pixels_) / column_blocks);
+		int end_column = (int)(((long long)(column_block + 1) * x_pixels_) / column_blocks);
+		int end = (int)(((long long)(row_block + 1) * lines) / row_blocks);
+		for (int l = (int)(((long long)row_block * lines) / row_blocks); l < end; l++)
+		{
+			Bin_Row(&samples[l * line_samples], first_line + l, first_column, end_column);
+		}
+	};
+	if ((row_blocks * column_blocks) > 1)
+	{
+		pool->Run(row_blocks * column_blocks, std::ref(bin_block));
+	}
+	else
+	{
+		bin_block(0);
+	}
+
+	// Advance scan line indicator
+	current_line_ += lines;
+	return lines;
+}
+
+
+// Start the next frame if the previous line completed one
+void Binner::Next_Line()
+{
+	// Check if the previous line completed a frame...
+	if (current_line_ == y_pixels_)
+	{
+		// Reset scan_line pointer and increment frame counter (reset after a full set of averages)
+		current_line_ = 0;
+		current_frame_++;
+		if (current_frame_ == frames_to_average_)
+		{
+			current_frame_ = 0;
+		}
+	}
+}
+
+
+// Bin a line into (columns of) a row (common channel counts unroll the channel loop)
+void Binner::Bin_Row(const double* samples, int line, int first_column, int end_column)
+{
+	switch (num_chans_)
+	{
+	case 1: Bin_Line_Chans<1>(samples, line, first_column, end_column); break;
+	case 2: Bin_Line_Chans<2>(samples, line, first_column, end_column); break;
+	case 4: Bin_Line_Chans<4>(samples, line, first_column, end_column); break;
+	default: Bin_Line_Chans<0>(samples, line, first_column, end_column); break;
+	}
+}
+
+
+// Running average frame of a channel
+float* Binner::Channel(int channel)
+{
+	return &frames_[(size_t)channel * x_pixels_ * y_pixels_];
+}
+
+
+// Bin a line (columns first_column to end_column) of every channel
+template <int chans>
+void Binner::Bin_Line_Chans(const double* samples, int line, int first_column, int end_column)
+{
+	// Channel count (compile time constant, if known)
+	const int num_chans = (chans > 0) ? chans : num_chans_;
+	const size_t plane = (size_t)x_pixels_ * y_pixels_;
+
+	// Loop though (forward scan) columns
+	float accum[binner_max_chans];
+	float* row = &frames_[(size_t)line * x_pixels_];
+	const double* pixel = &samples[(size_t)(phase_ + first_column) * bin_factor_ * num_chans];
+	for (int c = first_column; c < end_column; c++)
+	{
+		// Bin subsequent samples into a pixel value (of each channel)
+		for (int ch = 0; ch < num_chans; ch++) { accum[ch] = 0.0f; }
+		for (int b = 0; b < bin_factor_*num_chans; b += num_chans)
+		{
+			for (int ch = 0; ch < num_chans; ch++)
+			{
+				accum[ch] += (float)pixel[b + ch];
+			}
+		}
+		pixel += bin_factor_ * num_chans;
+
+		// Store running average pixel value for display/saving
+		for (int ch = 0; ch < num_chans; ch++)
+		{
+			float* value = &row[ch * plane + c];
+			if (current_frame_ > 0)
+			{
+				// Weight current pixel value by number of averages thus far, add new measurement, divide by number of frames acquired
+				*value = ((*value * (float)(current_frame_)) + (accum[ch] / (float)bin_factor_)) / (float)(current_frame_ + 1);
+			}
+			else {
+				*value = accum[ch] / (float)bin_factor_;
+			}
+		}
+	}
+}
+
+
+// Did the last line complete a frame?
+bool Binner::Frame_Complete()
+{
+	return (current_line_ == y_pixels_);
+}
+
+
+// Did the last line complete a full set of averaged frames?
+bool Binner::Group_Complete()
+{
+	return (current_line_ == y_pixels_) && (current_frame_ == (frames_to_average_ - 1));
+}
+
+
+// Current scan line (number of lines binned into the current frame)
+int Binner::Current_Line()
+{
+	return current_line_;
+}
+
+
+// Current frame (within the group of averaged frames)
+int Binner::Current_Frame()
+{
+	return current_frame_;
+}
+
+// FIN
@@ -0,0 +1,61 @@
+// Dreo2P Binner Class (header)
+#pragma once
+// Include STD headers
+#include <vector>
+#include <cstddef>
+#include <functional>
+
+// Inlcude Local Headers
+#include "Worker_Pool.h"
+
+// Maximum number of binned channels
+static const int	binner_max_chans = 8;
+
+// Fewest samples worth a worker pool task (waking a worker costs about as long as binning these)
+static const int	binner_min_task_samples = 16384;
+
+class Binner
+{
+public:
+	// Constructors
+	Binner(int x_pixels, int y_pixels, int pixels_per_line, int bin_factor, int frames_to_average, int phase, int num_chans, float* frames = NULL);	// frames: caller's storage (e.g. an arena) for num_chans frames, NULL = own
+
+	// Destructors
+	~Binner();
+
+	// Public Members (running average frames, one plane per channel in a single allocation)
+	float*	frames_;
+
+	// Public Methods
+	void	Reset();
+	void	Bin_Line(const double* samples);	// Bin one full scan line of interleaved (num_chans) samples
+	int		Bin_Lines(const double* samples, int num_lines, Worker_Pool* pool);	// Bin consecutive full scan lines, up to the end of the current frame (returns the number binned), split by rows or columns across the pool (NULL = this thread)
+	float*	Channel(int channel);				// Running average frame of a channel
+	bool	Frame_Complete();
+	bool	Group_Complete();
+	int		Current_Line();
+	int		Current_Frame();
+
+private:
+	// Private Members (scan geometry)
+	int		x_pixels_;
+	int		y_pixels_;
+	int		pixels_per_line_;
+	int		bin_factor_;
+	int		frames_to_average_;
+	int		phase_;				// First binned pixel of each line that is kept (forward scan start)
+	int		num_chans_;
+	std::vector<float>	own_frames_;	// Storage, unless the caller's
+
+	// Private Members (position in the scan)
+	int		current_line_ = 0;
+	int		current_frame_ = 0;
+
+	// Private Methods
+	void	Next_Line();						// Move to the next frame if the previous line completed one
+	void	Bin_Row(const double* samples, int line, int first_column, int end_column);
+
+	// Private Methods (binning kernel, with the channel count fixed at compile time for common setups, 0 = any)
+	template <int chans>
+	void	Bin_Line_Chans(const double* samples, int line, int first_column, int end_column);
+};
@@ -0,0 +1,49 @@
+// Dreo2P CPU Meter Class (source)
+#include "Cpu_Meter.h"
+
+#ifdef _WIN32
+// Sum of kernel and user FILETIMEs (100 ns units) in seconds
+static double Cpu_Seconds(HANDLE thread)
+{
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(thread, &creation, &exit, &kernel, &user)) { return 0.0; }
+	unsigned long long kernel_ticks = ((unsigned long long)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	unsigned long long user_ticks = ((unsigned long long)user.dwHighDateTime << 32) | user.dwLowDateTime;
+	return (double)(kernel_ticks + user_ticks) * 1e-7;
+}
+#else
+// Read a thread CPU clock in seconds
+static double Cpu_Seconds(clockid_t clock)
+{
+	struct timespec time;
+	if (clock_gettime(clock, &time) != 0) { return 0.0; }
+	return (double)time.tv_sec + ((double)time.tv_nsec * 1e-9);
+}
+#endif
+
+
+// CPU time of a running thread (0 if it is not running)
+double Cpu_Meter::Thread_Seconds(std::thread& thread)
+{
+	if (!thread.joinable()) { return 0.0; }
+#ifdef _WIN32
+	return Cpu_Seconds((HANDLE)thread.native_handle());
+#else
+	clockid_t clock;
+	if (pthread_getcpuclockid(thread.native_handle(), &clock) != 0) { return 0.0; }
+	return Cpu_Seconds(clock);
+#endif
+}
+
+
+// CPU time of the calling thread
+double Cpu_Meter::Current_Thread_Seconds()
+{
+#ifdef _WIN32
+	return Cpu_Seconds(GetCurrentThread());
+#else
+	return Cpu_Seconds(CLOCK_THREAD_CPUTIME_ID);
+#endif
+}
+
+// FIN
@@ -0,0 +1,21 @@
+// Dreo2P CPU Meter Class (header)
+#pragma once
+// Include STD headers
+#include <thread>
+
+// Include platform headers (per thread CPU clocks)
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+// CPU time (user + kernel) consumed by a thread
+class Cpu_Meter
+{
+public:
+	// Public Methods
+	static double	Thread_Seconds(std::thread& thread);	// A running thread
+	static double	Current_Thread_Seconds();				// The calling thread
+};
@@ -0,0 +1,87 @@
+// Dreo2P DAQ Source Class (source)
+#include "Daq_Source.h"
+
+// Constructor
+Daq_Source::Daq_Source(TaskHandle AI_taskHandle, int num_chans, double scaling_coeffs[][4])
+{
+	AI_taskHandle_ = AI_taskHandle;
+	num_chans_ = num_chans;
+	memcpy(scaling_coeffs_, scaling_coeffs, sizeof(scaling_coeffs_));
+}
+
+
+// Destructor
+Daq_Source::~Daq_Source()
+{
+}
+
+
+// Start hardware acquisition
+int Daq_Source::Start()
+{
+	return DAQmxStartTask(AI_taskHandle_);
+}
+
+
+// Read samples from the device buffer (raw samples are read as int16 and scaled to volts here)
+int Daq_Source::Read(int num_scans, double* volts, short* raw, int max_scans)
+{
+	int32 num_read_samples = 0;
+	int status;
+	if (raw != NULL)
+	{
+		status = DAQmxReadBinaryI16(AI_taskHandle_, num_scans, 1.0, DAQmx_Val_GroupByScanNumber, raw, max_scans * num_chans_, &num_read_samples, NULL);
+		Raw_Recorder::Scale_Samples(raw, volts, num_read_samples, num_chans_, scaling_coeffs_);
+	}
+	else
+	{
+		status = DAQmxReadAnalogF64(AI_taskHandle_, num_scans, 1.0, DAQmx_Val_GroupByScanNumber, volts, max_scans * num_chans_, &num_read_samples, NULL);
+	}
+	return (status < 0) ? status : num_read_samples;
+}
+
+
+// Stop hardware acquisition
+int Daq_Source::Stop()
+{
+	return DAQmxStopTask(AI_taskHandle_);
+}
+
+
+// The device delivers samples in real time
+bool Daq_Source::Is_Paced()
+{
+	return true;
+}
+
+
+// The device never runs out of samples
+bool Daq_Source::Is_Finished()
+{
+	return false;
+}
+
+
+// Scans waiting in the device buffer
+long long Daq_Source::Backlog()
+{
+	uInt32 available = 0;
+	DAQmxGetReadAvailSampPerChan(AI_taskHandle_, &available);
+	return (long long)available;
+}
+
+
+// The device reports overflow as a read error instead
+long long Daq_Source::Scans_Dropped()
+{
+	return 0;
+}
+
+
+// Samples per scan
+int Daq_Source::Num_Chans()
+{
+	return num_chans_;
+}
+
+// FIN
@@ -0,0 +1,32 @@
+// Dreo2P DAQ Source Class (header)
+#pragma once
+// Inlcude Local Headers
+#include "NIDAQmx.h"
+#include "Sample_Source.h"
+#include "Raw_Recorder.h"
+
+class Daq_Source : public Sample_Source
+{
+public:
+	// Constructors
+	Daq_Source(TaskHandle AI_taskHandle, int num_chans, double scaling_coeffs[][4]);
+
+	// Destructors
+	~Daq_Source();
+
+	// Public Methods
+	int		Start();
+	int		Read(int num_scans, double* volts, short* raw, int max_scans);
+	int		Stop();
+	bool	Is_Paced();
+	bool	Is_Finished();
+	long long	Backlog();
+	long long	Scans_Dropped();
+	int			Num_Chans();
+
+private:
+	// Private Members (NIDAQmx)
+	TaskHandle	AI_taskHandle_;
+	int			num_chans_;
+	double		scaling_coeffs_[raw_max_chans][4];	// Device scaling of raw samples to volts
+};
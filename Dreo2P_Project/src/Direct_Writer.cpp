@@ -0,0 +1,461 @@
+// Dreo2P Direct Writer Class (source)
+#include "Direct_Writer.h"
+
+// Include platform headers
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#endif
+
+// Number of latency samples kept for the percentiles
+static const int	latency_samples = 65536;
+
+// Constructor
+Direct_Writer::Direct_Writer(std::string path, long long preallocate_bytes, long long start_offset, int buffer_bytes, int num_buffers)
+{
+	// Set buffer pool size (whole number of aligned blocks)
+	buffer_bytes_ = std::max(direct_alignment, (buffer_bytes / direct_alignment) * direct_alignment);
+	num_buffers_ = std::max(2, num_buffers);
+	start_offset_ = start_offset;
+	file_offset_ = start_offset;
+	end_offset_ = start_offset;
+
+	// Allocate aligned buffers (once)
+	for (int b = 0; b < num_buffers_; b++)
+	{
+		buffers_.push_back(Aligned_Alloc(buffer_bytes_));
+	}
+	in_flight_.resize(num_buffers_, false);
+	write_offset_.resize(num_buffers_, 0);
+	write_bytes_.resize(num_buffers_, 0);
+	submit_time_.resize(num_buffers_);
+	submit_latency_.resize(latency_samples);
+	complete_latency_.resize(latency_samples);
+
+#ifdef _WIN32
+	// Open unbuffered (bypass the file cache) for overlapped writes
+	file_ = CreateFileA(path.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED, NULL);
+	if (file_ == INVALID_HANDLE_VALUE) { failed_ = true; }
+
+	// Preallocate (reserves the space, the file system still zero fills ahead of writes, so stale disk contents never appear in the file)
+	if (!failed_ && (preallocate_bytes > 0))
+	{
+		LARGE_INTEGER size;
+		size.QuadPart = ((preallocate_bytes + direct_alignment - 1) / direct_alignment) * direct_alignment;
+		SetFilePointerEx(file_, size, NULL, FILE_BEGIN);
+		SetEndOfFile(file_);
+	}
+
+	// One event per buffer
+	overlapped_.resize(num_buffers_);
+	for (int b = 0; b < num_buffers_; b++)
+	{
+		memset(&overlapped_[b], 0, sizeof(OVERLAPPED));
+		overlapped_[b].hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	}
+#else
+	// Open with O_DIRECT (bypass the page cache), fall back to buffered if the file system does not support it
+	file_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+	if (file_ < 0) { file_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644); }
+	if (file_ < 0) { failed_ = true; }
+
+	// Preallocate
+	if (!failed_ && (preallocate_bytes > 0))
+	{
+		fallocate(file_, 0, 0, preallocate_bytes);
+	}
+
+	// Set up io_uring submission and completion rings (one entry per buffer), fall back to pwrite if unavailable
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	ring_fd_ = failed_ ? -1 : (int)syscall(__NR_io_uring_setup, num_buffers_, &params);
+	if (ring_fd_ >= 0)
+	{
+		sq_ring_bytes_ = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+		cq_ring_bytes_ = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+		sqes_bytes_ = params.sq_entries * sizeof(struct io_uring_sqe);
+		sq_ring_ = mmap(NULL, sq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+		cq_ring_ = mmap(NULL, cq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+		sqes_ = (struct io_uring_sqe*)mmap(NULL, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+		if ((sq_ring_ == MAP_FAILED) || (cq_ring_ == MAP_FAILED) || (sqes_ == MAP_FAILED))
+		{
+			if (sq_ring_ != MAP_FAILED) { munmap(sq_ring_, sq_ring_bytes_); }
+			if (cq_ring_ != MAP_FAILED) { munmap(cq_ring_, cq_ring_bytes_); }
+			if (sqes_ != MAP_FAILED) { munmap(sqes_, sqes_bytes_); }
+			close(ring_fd_);
+			ring_fd_ = -1;
+		}
+		else
+		{
+			sq_tail_ = (unsigned*)((char*)sq_ring_ + params.sq_off.tail);
+			sq_mask_ = (unsigned*)((char*)sq_ring_ + params.sq_off.ring_mask);
+			sq_array_ = (unsigned*)((char*)sq_ring_ + params.sq_off.array);
+			cq_head_ = (unsigned*)((char*)cq_ring_ + params.cq_off.head);
+			cq_tail_ = (unsigned*)((char*)cq_ring_ + params.cq_off.tail);
+			cq_mask_ = (unsigned*)((char*)cq_ring_ + params.cq_off.ring_mask);
+			cqes_ = (struct io_uring_cqe*)((char*)cq_ring_ + params.cq_off.cqes);
+		}
+	}
+#endif
+
+	// Start throughput clock
+	open_time_ = std::chrono::steady_clock::now();
+	last_complete_time_ = open_time_;
+}
+
+
+// Destructor
+Direct_Writer::~Direct_Writer()
+{
+	Close();
+	for (int b = 0; b < (int)buffers_.size(); b++)
+	{
+		Aligned_Free(buffers_[b]);
+	}
+#ifdef _WIN32
+	for (int b = 0; b < (int)overlapped_.size(); b++)
+	{
+		CloseHandle(overlapped_[b].hEvent);
+	}
+#endif
+}
+
+
+// Is the file open (and have all writes succeeded)?
+bool Direct_Writer::Is_Open()
+{
+	return !failed_;
+}
+
+
+// Copy data into the current buffer, submitting each full buffer (waits only when all buffers are in flight)
+bool Direct_Writer::Append(const void* data, size_t bytes)
+{
+	const char* source = (const char*)data;
+	while ((bytes > 0) && !failed_)
+	{
+		// Make sure the current buffer is free
+		if (fill_ == 0) { Wait(current_); }
+
+		// Fill it
+		size_t chunk = std::min(bytes, (size_t)buffer_bytes_ - fill_);
+		memcpy(buffers_[current_] + fill_, source, chunk);
+		fill_ += chunk;
+		source += chunk;
+		bytes -= chunk;
+		end_offset_ += chunk;
+
+		// Submit when full and move on to the next buffer
+		if (fill_ == (size_t)buffer_bytes_)
+		{
+			Submit(current_, fill_);
+			current_ = (current_ + 1) % num_buffers_;
+			fill_ = 0;
+		}
+	}
+	return !failed_;
+}
+
+
+// Synchronous write at an aligned offset outside the appended region (e.g. a header)
+bool Direct_Writer::Write_At(long long offset, const void* data, size_t bytes)
+{
+	if (failed_) { return false; }
+
+	// Copy into an aligned bounce buffer (whole blocks)
+	size_t aligned_bytes = ((bytes + direct_alignment - 1) / direct_alignment) * direct_alignment;
+	char* block = Aligned_Alloc(aligned_bytes);
+	memset(block, 0, aligned_bytes);
+	memcpy(block, data, bytes);
+
+#ifdef _WIN32
+	OVERLAPPED overlapped;
+	memset(&overlapped, 0, sizeof(overlapped));
+	overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+	overlapped.OffsetHigh = (DWORD)(offset >> 32);
+	DWORD written = 0;
+	if (!WriteFile(file_, block, (DWORD)aligned_bytes, NULL, &overlapped) && (GetLastError() != ERROR_IO_PENDING)) { failed_ = true; }
+	else if (!GetOverlappedResult(file_, &overlapped, &written, TRUE) || (written != aligned_bytes)) { failed_ = true; }
+	CloseHandle(overlapped.hEvent);
+#else
+	if (pwrite(file_, block, aligned_bytes, offset) != (ssize_t)aligned_bytes) { failed_ = true; }
+#endif
+
+	Aligned_Free(block);
+	return !failed_;
+}
+
+
+// End of the appended data (file size after Close)
+long long Direct_Writer::End_Offset()
+{
+	return end_offset_;
+}
+
+
+// Throughput and latency percentiles
+Direct_Writer_Stats Direct_Writer::Stats()
+{
+	Direct_Writer_Stats stats;
+	double seconds = std::chrono::duration<double>(last_complete_time_ - open_time_).count();
+	stats.throughput = (seconds > 0.0) ? ((double)bytes_written_ / (1024.0 * 1024.0)) / seconds : 0.0;
+	stats.num_writes = num_completed_;
+	double percentiles[3] = { 50.0, 99.0, 99.9 };
+	for (int p = 0; p < 3; p++)
+	{
+		stats.submit_latency[p] = Percentile(submit_latency_, num_submitted_, percentiles[p]);
+		stats.complete_latency[p] = Percentile(complete_latency_, num_completed_, percentiles[p]);
+	}
+	return stats;
+}
+
+
+// Write the partial buffer (padded to a whole block), wait for all writes, trim the file to the appended data
+void Direct_Writer::Close()
+{
+#ifdef _WIN32
+	if (file_ == INVALID_HANDLE_VALUE) { return; }
+#else
+	if (file_ < 0) { return; }
+#endif
+
+	// Flush partial buffer
+	if ((fill_ > 0) && !failed_)
+	{
+		size_t padded = ((fill_ + direct_alignment - 1) / direct_alignment) * direct_alignment;
+		memset(buffers_[current_] + fill_, 0, padded - fill_);
+		Submit(current_, padded);
+		fill_ = 0;
+	}
+
+	// Wait for all writes
+	for (int b = 0; b < num_buffers_; b++)
+	{
+		Wait(b);
+	}
+
+	// Trim padding and unused preallocated space, and close
+#ifdef _WIN32
+	LARGE_INTEGER size;
+	size.QuadPart = end_offset_;
+	SetFilePointerEx(file_, size, NULL, FILE_BEGIN);
+	SetEndOfFile(file_);
+	CloseHandle(file_);
+	file_ = INVALID_HANDLE_VALUE;
+#else
+	if (ftruncate(file_, end_offset_) != 0) { failed_ = true; }
+	close(file_);
+	file_ = -1;
+	if (ring_fd_ >= 0)
+	{
+		munmap(sq_ring_, sq_ring_bytes_);
+		munmap(cq_ring_, cq_ring_bytes_);
+		munmap(sqes_, sqes_bytes_);
+		close(ring_fd_);
+		ring_fd_ = -1;
+	}
+#endif
+}
+
+
+// Submit a buffer for writing at the current file position
+void Direct_Writer::Submit(int buffer, size_t bytes)
+{
+	write_offset_[buffer] = file_offset_;
+	write_bytes_[buffer] = bytes;
+	in_flight_[buffer] = true;
+	file_offset_ += bytes;
+	submit_time_[buffer] = std::chrono::steady_clock::now();
+
+#ifdef _WIN32
+	OVERLAPPED& overlapped = overlapped_[buffer];
+	ResetEvent(overlapped.hEvent);
+	overlapped.Internal = 0;
+	overlapped.InternalHigh = 0;
+	overlapped.Offset = (DWORD)(write_offset_[buffer] & 0xFFFFFFFF);
+	overlapped.OffsetHigh = (DWORD)(write_offset_[buffer] >> 32);
+	if (!WriteFile(file_, buffers_[buffer], (DWORD)bytes, NULL, &overlapped) && (GetLastError() != ERROR_IO_PENDING))
+	{
+		failed_ = true;
+		in_flight_[buffer] = false;
+	}
+#else
+	if ((ring_fd_ >= 0) && ring_writes_)
+	{
+		// Fill a submission queue entry (never more than one per buffer in flight, so the queue cannot overflow)
+		unsigned tail = *sq_tail_;
+		unsigned index = tail & *sq_mask_;
+		struct io_uring_sqe* sqe = &sqes_[index];
+		memset(sqe, 0, sizeof(*sqe));
+		sqe->opcode = IORING_OP_WRITE;
+		sqe->fd = file_;
+		sqe->addr = (unsigned long long)buffers_[buffer];
+		sqe->len = (unsigned)bytes;
+		sqe->off = (unsigned long long)write_offset_[buffer];
+		sqe->user_data = (unsigned long long)buffer;
+		sq_array_[index] = index;
+		__atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+		// Tell the kernel
+		if (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, NULL, 0) != 1)
+		{
+			failed_ = true;
+			in_flight_[buffer] = false;
+		}
+	}
+	else
+	{
+		// Synchronous fallback
+		ssize_t written = pwrite(file_, buffers_[buffer], bytes, write_offset_[buffer]);
+		Complete(buffer, written);
+	}
+#endif
+
+	// Record submission latency, and collect finished writes (without waiting)
+	double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - submit_time_[buffer]).count();
+	Record_Latency(submit_latency_, num_submitted_, microseconds);
+	num_submitted_++;
+	Reap(false);
+}
+
+
+// A write finished (result = bytes written, or negative on error)
+void Direct_Writer::Complete(int buffer, long long result)
+{
+	if (!in_flight_[buffer]) { return; }
+	in_flight_[buffer] = false;
+	last_complete_time_ = std::chrono::steady_clock::now();
+
+#ifndef _WIN32
+	// A kernel without IORING_OP_WRITE (before 5.6) rejects the write, write it (and all later buffers) with pwrite
+	if ((result == -EINVAL) && (ring_fd_ >= 0))
+	{
+		ring_writes_ = false;
+		result = pwrite(file_, buffers_[buffer], write_bytes_[buffer], write_offset_[buffer]);
+	}
+#endif
+
+	// Finish short writes synchronously
+	if ((result >= 0) && (result < (long long)write_bytes_[buffer]))
+	{
+#ifdef _WIN32
+		failed_ = true;
+#else
+		ssize_t rest = pwrite(file_, buffers_[buffer] + result, write_bytes_[buffer] - result, write_offset_[buffer] + result);
+		result = (rest < 0) ? rest : result + rest;
+#endif
+	}
+	if (result != (long long)write_bytes_[buffer])
+	{
+		failed_ = true;
+		return;
+	}
+
+	// Update statistics
+	bytes_written_ += result;
+	double microseconds = std::chrono::duration<double, std::micro>(last_complete_time_ - submit_time_[buffer]).count();
+	Record_Latency(complete_latency_, num_completed_, microseconds);
+	num_completed_++;
+}
+
+
+// Collect finished writes (optionally waiting for at least one)
+void Direct_Writer::Reap(bool wait)
+{
+#ifdef _WIN32
+	for (int b = 0; b < num_buffers_; b++)
+	{
+		if (in_flight_[b] && (wait || HasOverlappedIoCompleted(&overlapped_[b])))
+		{
+			DWORD written = 0;
+			BOOL success = GetOverlappedResult(file_, &overlapped_[b], &written, TRUE);
+			Complete(b, success ? (long long)written : -1);
+			if (wait) { return; }
+		}
+	}
+#else
+	if (ring_fd_ < 0) { return; }
+	unsigned head = *cq_head_;
+	if (wait && (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)))
+	{
+		syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+	}
+	while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+	{
+		struct io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+		Complete((int)cqe->user_data, cqe->res);
+		head++;
+		__atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+	}
+#endif
+}
+
+
+// Wait until a buffer is no longer in flight
+void Direct_Writer::Wait(int buffer)
+{
+#ifdef _WIN32
+	if (in_flight_[buffer])
+	{
+		DWORD written = 0;
+		BOOL success = GetOverlappedResult(file_, &overlapped_[buffer], &written, TRUE);
+		Complete(buffer, success ? (long long)written : -1);
+	}
+#else
+	while (in_flight_[buffer] && (ring_fd_ >= 0))
+	{
+		Reap(true);
+	}
+#endif
+}
+
+
+// Store a latency sample (overwriting the oldest once full)
+void Direct_Writer::Record_Latency(std::vector<float>& samples, long long count, double microseconds)
+{
+	samples[count % latency_samples] = (float)microseconds;
+}
+
+
+// Allocate an aligned buffer
+char* Direct_Writer::Aligned_Alloc(size_t bytes)
+{
+#ifdef _WIN32
+	return (char*)_aligned_malloc(bytes, direct_alignment);
+#else
+	void* buffer = NULL;
+	if (posix_memalign(&buffer, direct_alignment, bytes) != 0) { return NULL; }
+	return (char*)buffer;
+#endif
+}
+
+
+// Free an aligned buffer
+void Direct_Writer::Aligned_Free(char* buffer)
+{
+#ifdef _WIN32
+	_aligned_free(buffer);
+#else
+	free(buffer);
+#endif
+}
+
+
+// Percentile of the stored latency samples
+double Direct_Writer::Percentile(std::vector<float> samples, long long count, double percentile)
+{
+	int num_samples = (int)std::min(count, (long long)latency_samples);
+	if (num_samples == 0) { return 0.0; }
+	int rank = std::min(num_samples - 1, (int)((percentile / 100.0) * num_samples));
+	std::nth_element(samples.begin(), samples.begin() + rank, samples.begin() + num_samples);
+	return samples[rank];
+}
+
+// FIN
@@ -0,0 +1,105 @@
+// Dreo2P Direct Writer Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+// Include platform headers (unbuffered overlapped I/O on Windows, O_DIRECT + io_uring on Linux)
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <linux/io_uring.h>
+#endif
+
+// Direct (unbuffered) I/O needs sector aligned buffers, offsets and sizes
+static const int	direct_alignment = 4096;
+
+// Sustained throughput and latency report
+struct Direct_Writer_Stats
+{
+	double		throughput;				// Bytes written to disk since open (MB/s)
+	long long	num_writes;
+	double		submit_latency[3];		// Time spent submitting a write (us): 50th, 99th and 99.9th percentile
+	double		complete_latency[3];	// Time from submission to completion (us): 50th, 99th and 99.9th percentile
+};
+
+class Direct_Writer
+{
+public:
+	// Constructors
+	Direct_Writer(std::string path, long long preallocate_bytes, long long start_offset, int buffer_bytes = 4 * 1024 * 1024, int num_buffers = 8);
+
+	// Destructors
+	~Direct_Writer();
+
+	// Public Methods
+	bool		Is_Open();
+	bool		Append(const void* data, size_t bytes);							// Copy into pooled buffers, submit each full buffer asynchronously
+	bool		Write_At(long long offset, const void* data, size_t bytes);		// Synchronous write at an aligned offset (e.g. a header)
+	long long	End_Offset();
+	Direct_Writer_Stats	Stats();
+	void		Close();														// Flush the partial buffer, wait for all writes, trim to End_Offset
+
+private:
+	// Private Members (file position)
+	long long			start_offset_;
+	long long			file_offset_;			// Next (aligned) write position
+	long long			end_offset_;			// End of appended data
+	bool				failed_ = false;
+
+	// Private Members (aligned buffer pool, used round-robin)
+	int					buffer_bytes_;
+	int					num_buffers_;
+	int					current_ = 0;
+	size_t				fill_ = 0;
+	std::vector<char*>	buffers_;
+	std::vector<bool>	in_flight_;
+	std::vector<long long>	write_offset_;
+	std::vector<size_t>	write_bytes_;
+	std::vector<std::chrono::steady_clock::time_point>	submit_time_;
+
+	// Private Members (statistics, latency samples in us, keeps the most recent)
+	std::vector<float>	submit_latency_;
+	std::vector<float>	complete_latency_;
+	long long			num_submitted_ = 0;
+	long long			num_completed_ = 0;
+	long long			bytes_written_ = 0;
+	std::chrono::steady_clock::time_point	open_time_;
+	std::chrono::steady_clock::time_point	last_complete_time_;
+
+	// Private Members (platform file and completion queue)
+#ifdef _WIN32
+	HANDLE				file_ = INVALID_HANDLE_VALUE;
+	std::vector<OVERLAPPED>	overlapped_;
+#else
+	int					file_ = -1;
+	int					ring_fd_ = -1;				// io_uring (-1 = synchronous pwrite fallback)
+	bool				ring_writes_ = true;		// Does the kernel support IORING_OP_WRITE (5.6+)? Otherwise pwrite, the ring only drains
+	void*				sq_ring_ = NULL;
+	void*				cq_ring_ = NULL;
+	size_t				sq_ring_bytes_ = 0;
+	size_t				cq_ring_bytes_ = 0;
+	struct io_uring_sqe*	sqes_ = NULL;
+	size_t				sqes_bytes_ = 0;
+	unsigned*			sq_tail_ = NULL;
+	unsigned*			sq_mask_ = NULL;
+	unsigned*			sq_array_ = NULL;
+	unsigned*			cq_head_ = NULL;
+	unsigned*			cq_tail_ = NULL;
+	unsigned*			cq_mask_ = NULL;
+	struct io_uring_cqe*	cqes_ = NULL;
+#endif
+
+	// Private Methods
+	void		Submit(int buffer, size_t bytes);
+	void		Complete(int buffer, long long result);
+	void		Reap(bool wait);
+	void		Wait(int buffer);
+	void		Record_Latency(std::vector<float>& samples, long long count, double microseconds);
+	static char*	Aligned_Alloc(size_t bytes);
+	static void		Aligned_Free(char* buffer);
+	static double	Percentile(std::vector<float> samples, long long count, double percentile);
+};
@@ -1,6 +1,10 @@
 // Dreo2P Display Class (source)
 #include "Display.h"
 
+// GLFW users (displays with a window)
+std::mutex Display::glfw_mutex_;
+int Display::glfw_users_ = 0;
+
 // Constructor
 Display::Display(int frame_width, int frame_height)
 {
@@ -36,10 +40,27 @@ void Display::Display_Thread_Function()
 	while (Display::active_)
 	{
 		// Update frame texture
+		unsigned long long upload_start = Tsc_Clock::Now();
 		Display::Update_Frame();
 
 		// Draw stuff
+		unsigned long long render_start = Tsc_Clock::Now();
 		Display::Render();
+		unsigned long long render_end = Tsc_Clock::Now();
+
+		// Record stage latencies (if instrumented)
+		Latency_Histogram* upload_latency = upload_latency_;
+		Latency_Histogram* render_latency = render_latency_;
+		if (upload_latency != NULL) { upload_latency->Record(render_start - upload_start); }
+		if (render_latency != NULL) { render_latency->Record(render_end - render_start); }
+
+		// Trace (if recording)
+		Trace_Buffer* trace = trace_;
+		if (trace != NULL)
+		{
+			trace->Record("Upload", upload_start, render_start);
+			trace->Record("Render", render_start, render_end);
+		}
 	}
 }
 
@@ -47,18 +68,18 @@ void Display::Display_Thread_Function()
 // Initialize GLFW winodw
 void Display::Initialize_Window(int width, int height)
 {
-	// Set GLFW error callback function
-	glfwSetErrorCallback(Error_Handler);
-
 	// Set window size members
 	window_width_ = width;
 	window_height_ = height;
 
-	// Initialize the GLFW library
-	if (!glfwInit())
+	// Set GLFW error callback function and initialize the GLFW library (unless another display already has), GLFW calls are serialized across displays
+	std::unique_lock<std::mutex> lock(glfw_mutex_);
+	glfwSetErrorCallback(Error_Handler);
+	if ((glfw_users_ == 0) && !glfwInit())
 	{
 		exit(EXIT_FAILURE);
 	}
+	glfw_users_++;
 
 	// Specify OpenGL version (4.1)
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -70,9 +91,12 @@ void Display::Initialize_Window(int width, int height)
 	window_ = glfwCreateWindow(window_width_, window_height_, "Dreo2P - Live", NULL, NULL);
 	if (!window_)
 	{
-		glfwTerminate();
+		// Terminate only if no other display has a window
+		glfw_users_--;
+		if (glfw_users_ == 0) { glfwTerminate(); }
 		exit(EXIT_FAILURE);
 	}
+	lock.unlock();
 
 	// Make the window's context current
 	glfwMakeContextCurrent(window_);
@@ -263,7 +287,10 @@ void Display::Render()
 	double time = glfwGetTime();
 
 	// Get framebuffer size and compute aspect ratio
-	glfwGetFramebufferSize(window_, &window_width_, &window_height_);
+	{
+		std::lock_guard<std::mutex> lock(glfw_mutex_);
+		glfwGetFramebufferSize(window_, &window_width_, &window_height_);
+	}
 	aspect_ratio = window_width_ / (float)window_height_;
 
 	// Set viewport size
@@ -275,7 +302,10 @@ void Display::Render()
 
 	// Get user input (mouse cursor position)
 	double xpos, ypos;
-	glfwGetCursorPos(window_, &xpos, &ypos);
+	{
+		std::lock_guard<std::mutex> lock(glfw_mutex_);
+		glfwGetCursorPos(window_, &xpos, &ypos);
+	}
 
 	// DRAWING
 
@@ -299,26 +329,62 @@ void Display::Render()
 	// Draw Quad (as two triangles)
 	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
-	// Check for user input (or other events, e.g. window close)
-	glfwPollEvents();
+	// Check for user input (or other events, e.g. window close), one display at a time
+	{
+		std::lock_guard<std::mutex> lock(glfw_mutex_);
+		glfwPollEvents();
+	}
 
 	// Swap buffers (v-synced)
 	glfwSwapBuffers(window_);
 }
 
 
+// CPU time used by the display thread (seconds)
+double Display::Cpu_Seconds()
+{
+	return Cpu_Meter::Thread_Seconds(display_thread_);
+}
+
+
+// Time texture uploads and renders (on the display thread)
+void Display::Set_Latency_Histograms(Latency_Histogram* upload, Latency_Histogram* render)
+{
+	upload_latency_ = upload;
+	render_latency_ = render;
+}
+
+
+// Trace texture uploads and renders (the buffer is only written by the display thread)
+void Display::Set_Trace(Trace_Buffer* trace)
+{
+	trace_ = trace;
+}
+
+
+// Tune the display thread
+bool Display::Set_Thread_Options(Thread_Options options)
+{
+	return Thread_Tuning::Apply(display_thread_, options);
+}
+
+
 // Stop thread, close window (and terminate GLFW)
 void Display::Close()
 {
-	// End scanning thread (if active)
-	if (active_)
+	// End display thread (if active)
+	if (!active_) { return; }
+	active_ = false;
+	display_thread_.join();
+
+	// Close GLFW window and terminate (if this was the last display)
+	std::lock_guard<std::mutex> lock(glfw_mutex_);
+	glfwDestroyWindow(window_);
+	glfw_users_--;
+	if (glfw_users_ == 0)
 	{
-		active_ = false;
-		display_thread_.join();
+		glfwTerminate();
 	}
-
-	// Close GLFW window and terminate
-	glfwTerminate();
 }
 
 
@@ -16,8 +16,15 @@
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <mutex>
 #include <vector>
 
+// Inlcude Local Headers
+#include "Cpu_Meter.h"
+#include "Latency_Histogram.h"
+#include "Trace_Recorder.h"
+#include "Thread_Tuning.h"
+
 class Display
 {
 public:
@@ -40,6 +47,10 @@ public:
 	std::atomic<float>	horz_line_ = -1.0f;
 
 	// Public Methods
+	double Cpu_Seconds();
+	void Set_Latency_Histograms(Latency_Histogram* upload, Latency_Histogram* render);	// Time texture uploads and renders (NULL = none)
+	void Set_Trace(Trace_Buffer* trace);													// Trace texture uploads and renders (NULL = none)
+	bool Set_Thread_Options(Thread_Options options);										// Priority and CPU of the display thread (false if refused)
 	void Close();
 
 private:
@@ -55,6 +66,13 @@ private:
 	// Private Members (display thread)
 	std::thread			display_thread_;
 	std::atomic<bool>	active_ = false;
+	std::atomic<Latency_Histogram*>	upload_latency_ = NULL;
+	std::atomic<Latency_Histogram*>	render_latency_ = NULL;
+	std::atomic<Trace_Buffer*>		trace_ = NULL;
+
+	// Private Members (GLFW is shared by every display in the process, initialized by the first and terminated by the last, its window and event calls are made under the mutex)
+	static std::mutex	glfw_mutex_;
+	static int			glfw_users_;
 
 	// Thread Function
 	void		Display_Thread_Function();
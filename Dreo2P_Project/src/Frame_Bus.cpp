@@ -0,0 +1,98 @@
+// Dreo2P Frame Bus Class (source)
+#include "Frame_Bus.h"
+
+// Constructor
+Frame_Bus::Frame_Bus(Frame_Pool* pool)
+{
+	pool_ = pool;
+}
+
+
+// Destructor
+Frame_Bus::~Frame_Bus()
+{
+}
+
+
+// Add a subscriber (from the next publish)
+int Frame_Bus::Subscribe(Frame_Subscriber subscriber)
+{
+	std::shared_ptr<Subscription> entry = std::make_shared<Subscription>();
+	entry->subscriber = subscriber;
+	entry->active = true;
+	std::lock_guard<std::mutex> lock(bus_mutex_);
+	entry->id = next_id_++;
+	subscriptions_.push_back(entry);
+	return entry->id;
+}
+
+
+// Remove a subscriber (waits for a publish in progress, unless called by a subscriber during it: then it is skipped for the rest of the publish)
+void Frame_Bus::Unsubscribe(int subscription)
+{
+	std::unique_lock<std::mutex> lock(bus_mutex_);
+	for (size_t i = 0; i < subscriptions_.size(); i++)
+	{
+		if (subscriptions_[i]->id == subscription)
+		{
+			subscriptions_[i]->active = false;
+			subscriptions_.erase(subscriptions_.begin() + i);
+			break;
+		}
+	}
+	if (publishing_thread_ != std::this_thread::get_id())
+	{
+		publish_done_.wait(lock, [this] { return !publishing_; });
+	}
+}
+
+
+// Copy a frame into the pool (once) and hand it to every subscriber
+bool Frame_Bus::Publish(const float* frames, double timestamp)
+{
+	// Publish to the pool (the frame stays valid until the next publish)
+	Frame_Ref frame;
+	if (!pool_->Publish(frames, timestamp, &frame)) { return false; }
+
+	// Take a snapshot of the subscribers (so they can subscribe and unsubscribe while being called)
+	{
+		std::lock_guard<std::mutex> lock(bus_mutex_);
+		frames_published_++;
+		delivering_.assign(subscriptions_.begin(), subscriptions_.end());
+		publishing_ = true;
+		publishing_thread_ = std::this_thread::get_id();
+	}
+
+	// Deliver (outside the lock, skipping subscribers removed meanwhile)
+	for (size_t i = 0; i < delivering_.size(); i++)
+	{
+		if (delivering_[i]->active) { delivering_[i]->subscriber(frame); }
+	}
+
+	// Publish done (wakes unsubscribers waiting for it)
+	{
+		std::lock_guard<std::mutex> lock(bus_mutex_);
+		publishing_ = false;
+		publishing_thread_ = std::thread::id();
+	}
+	publish_done_.notify_all();
+	delivering_.clear();
+	return true;
+}
+
+
+// Frame pool (to add and release references)
+Frame_Pool* Frame_Bus::Pool()
+{
+	return pool_;
+}
+
+
+// Number of frames published
+long long Frame_Bus::Frames_Published()
+{
+	std::lock_guard<std::mutex> lock(bus_mutex_);
+	return frames_published_;
+}
+
+// FIN
@@ -0,0 +1,55 @@
+// Dreo2P Frame Bus Class (header)
+#pragma once
+// Include STD headers
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <thread>
+
+// Inlcude Local Headers
+#include "Frame_Pool.h"
+
+// Frame subscriber: called on the publishing thread for each published frame, must return quickly
+// (the frame is immutable and shared by every subscriber, add a reference to the pool to keep it beyond the call, subscribers may subscribe and unsubscribe)
+typedef std::function<void(const Frame_Ref& frame)>	Frame_Subscriber;
+
+// Publishes each frame once into the pool and hands the same buffer to every subscriber (display, writer, clients and analysis stages)
+class Frame_Bus
+{
+public:
+	// Constructors
+	Frame_Bus(Frame_Pool* pool);
+
+	// Destructors
+	~Frame_Bus();
+
+	// Public Methods
+	int			Subscribe(Frame_Subscriber subscriber);		// Returns the subscription (to unsubscribe), called from the next publish
+	void		Unsubscribe(int subscription);				// Returns once the subscriber is no longer being called (from a subscriber: not called again, without waiting)
+	bool		Publish(const float* frames, double timestamp);	// Single publisher (false if the pool had no free buffer, the frame is dropped)
+	Frame_Pool*	Pool();
+	long long	Frames_Published();
+
+private:
+	// Private Members
+	struct Subscription
+	{
+		int					id;
+		Frame_Subscriber	subscriber;
+		std::atomic<bool>	active;			// Cleared on unsubscribe (a publish in progress skips it)
+	};
+	Frame_Pool*			pool_;
+	std::vector<std::shared_ptr<Subscription>>	subscriptions_;
+	int					next_id_ = 0;
+	long long			frames_published_ = 0;
+	std::mutex			bus_mutex_;
+
+	// Private Members (publish in progress, subscribers are called outside the lock from a snapshot of the list)
+	std::vector<std::shared_ptr<Subscription>>	delivering_;	// Publisher only (keeps its capacity, no allocation per frame)
+	bool				publishing_ = false;
+	std::thread::id		publishing_thread_;
+	std::condition_variable	publish_done_;
+};
@@ -0,0 +1,194 @@
+// Dreo2P Frame Pool Class (source)
+#include "Frame_Pool.h"
+
+// Constructor
+Frame_Pool::Frame_Pool(int width, int height, int num_chans, int num_buffers)
+{
+	// Set parameters
+	width_ = width;
+	height_ = height;
+	num_chans_ = num_chans;
+	num_buffers_ = std::max(2, num_buffers);
+	buffer_floats_ = (size_t)width_ * height_ * num_chans_;
+
+	// Make space for frames (allocated once and aligned, so references stay valid and copies are fast)
+	size_t buffer_bytes = ((buffer_floats_ * sizeof(float) + frame_alignment - 1) / frame_alignment) * frame_alignment;
+	buffers_.resize(num_buffers_);
+	for (int i = 0; i < num_buffers_; i++)
+	{
+#ifdef _WIN32
+		buffers_[i] = (float*)_aligned_malloc(buffer_bytes, frame_alignment);
+#else
+		void* buffer = NULL;
+		buffers_[i] = (posix_memalign(&buffer, frame_alignment, buffer_bytes) == 0) ? (float*)buffer : NULL;
+#endif
+		if (buffers_[i] == NULL)
+		{
+			allocated_ = false;
+			continue;
+		}
+		std::fill(buffers_[i], buffers_[i] + buffer_floats_, 0.0f);
+	}
+	refs_.resize(num_buffers_, 0);
+	sequence_.resize(num_buffers_, -1);
+	timestamp_.resize(num_buffers_, 0.0);
+}
+
+
+// Destructor
+Frame_Pool::~Frame_Pool()
+{
+	for (int i = 0; i < num_buffers_; i++)
+	{
+#ifdef _WIN32
+		_aligned_free(buffers_[i]);
+#else
+		free(buffers_[i]);
+#endif
+	}
+}
+
+
+// Publish a frame (scanner thread), the published frame is valid until the next publish (add a reference to keep it longer)
+bool Frame_Pool::Publish(const float* frames, double timestamp, Frame_Ref* frame)
+{
+	// Find a buffer nobody holds (the copy is done outside the lock, an unreferenced buffer can only be taken by this thread)
+	int slot = -1;
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex_);
+		for (int i = 0; i < num_buffers_; i++)
+		{
+			if (refs_[i] == 0)
+			{
+				slot = i;
+				break;
+			}
+		}
+		if (slot < 0)
+		{
+			frames_dropped_++;
+			next_sequence_++;
+			return false;
+		}
+	}
+
+	// Copy the planes of every channel (the only copy, readers share the buffer)
+	std::copy(frames, frames + buffer_floats_, buffers_[slot]);
+
+	// Make it the latest frame (the pool's reference moves from the previous one)
+	std::lock_guard<std::mutex> lock(pool_mutex_);
+	sequence_[slot] = next_sequence_++;
+	timestamp_[slot] = timestamp;
+	refs_[slot]++;
+	if (latest_ >= 0)
+	{
+		refs_[latest_]--;
+	}
+	latest_ = slot;
+
+	// Describe it
+	if (frame != NULL)
+	{
+		frame->data = buffers_[slot];
+		frame->width = width_;
+		frame->height = height_;
+		frame->num_chans = num_chans_;
+		frame->slot = slot;
+		frame->sequence = sequence_[slot];
+		frame->timestamp = timestamp;
+	}
+	return true;
+}
+
+
+// Keep a frame
+void Frame_Pool::Add_Ref(const Frame_Ref& frame)
+{
+	if ((frame.slot < 0) || (frame.slot >= num_buffers_)) { return; }
+	std::lock_guard<std::mutex> lock(pool_mutex_);
+	refs_[frame.slot]++;
+}
+
+
+// Release a kept frame
+void Frame_Pool::Release(const Frame_Ref& frame)
+{
+	if ((frame.slot < 0) || (frame.slot >= num_buffers_)) { return; }
+	std::lock_guard<std::mutex> lock(pool_mutex_);
+	Unref(frame.slot);
+}
+
+
+// Lease the latest frame
+bool Frame_Pool::Acquire(int channel, Frame_Lease* lease)
+{
+	std::lock_guard<std::mutex> lock(pool_mutex_);
+	if ((latest_ < 0) || (channel < 0) || (channel >= num_chans_))
+	{
+		lease->data = NULL;
+		lease->slot = -1;
+		return false;
+	}
+	refs_[latest_]++;
+	lease->data = buffers_[latest_] + (size_t)channel * width_ * height_;
+	lease->width = width_;
+	lease->height = height_;
+	lease->channel = channel;
+	lease->slot = latest_;
+	lease->sequence = sequence_[latest_];
+	lease->timestamp = timestamp_[latest_];
+	return true;
+}
+
+
+// Release a lease (the buffer is reused once no lease and not the latest)
+void Frame_Pool::Release(Frame_Lease* lease)
+{
+	if ((lease->slot < 0) || (lease->slot >= num_buffers_)) { return; }
+	std::lock_guard<std::mutex> lock(pool_mutex_);
+	Unref(lease->slot);
+	lease->data = NULL;
+	lease->slot = -1;
+}
+
+
+// Sequence number of the latest frame
+long long Frame_Pool::Latest_Sequence()
+{
+	std::lock_guard<std::mutex> lock(pool_mutex_);
+	return (latest_ >= 0) ? sequence_[latest_] : -1;
+}
+
+
+// Frames that could not be published
+long long Frame_Pool::Frames_Dropped()
+{
+	std::lock_guard<std::mutex> lock(pool_mutex_);
+	return frames_dropped_;
+}
+
+
+// Number of frame buffers
+int Frame_Pool::Num_Buffers()
+{
+	return num_buffers_;
+}
+
+
+// Whether every frame buffer was allocated
+bool Frame_Pool::Allocated()
+{
+	return allocated_;
+}
+
+
+// Drop a reference (pool mutex held)
+void Frame_Pool::Unref(int slot)
+{
+	if (refs_[slot] > 0)
+	{
+		refs_[slot]--;
+	}
+}
+
+// FIN
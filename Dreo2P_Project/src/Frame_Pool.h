@@ -0,0 +1,80 @@
+// Dreo2P Frame Pool Class (header)
+#pragma once
+// Include STD headers
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Frame buffers are aligned to cache lines (and start on a page when large)
+static const int	frame_alignment = 4096;
+
+// Read lease on a published frame (valid until released, the pool does not reuse a leased buffer)
+struct Frame_Lease
+{
+	const float*	data;			// Pixels of the leased channel (row major, width * height)
+	int				width;
+	int				height;
+	int				channel;
+	int				slot;			// Pool buffer (-1 = no frame)
+	long long		sequence;		// Number of the published frame (counts from 0, gaps are frames the caller missed)
+	double			timestamp;		// Seconds since the scanner was initialized
+};
+
+// Reference to a published (immutable) frame with every channel
+struct Frame_Ref
+{
+	const float*	data;			// Channel planes (num_chans * width * height)
+	int				width;
+	int				height;
+	int				num_chans;
+	int				slot;			// Pool buffer (-1 = no frame)
+	long long		sequence;
+	double			timestamp;
+};
+
+class Frame_Pool
+{
+public:
+	// Constructors
+	Frame_Pool(int width, int height, int num_chans, int num_buffers);
+
+	// Destructors
+	~Frame_Pool();
+
+	// Public Methods (publisher, a single thread)
+	bool		Publish(const float* frames, double timestamp, Frame_Ref* frame = NULL);	// Copy a frame (planes of all channels) into a free buffer and make it the latest (false if every buffer is referenced)
+
+	// Public Methods (references, from any thread)
+	void		Add_Ref(const Frame_Ref& frame);				// Keep a frame (until released)
+	void		Release(const Frame_Ref& frame);
+	bool		Acquire(int channel, Frame_Lease* lease);		// Lease the latest frame (false if none published yet)
+	void		Release(Frame_Lease* lease);
+	long long	Latest_Sequence();								// -1 = none
+	long long	Frames_Dropped();								// Not published (all buffers referenced)
+	int			Num_Buffers();
+	bool		Allocated();									// False if a buffer could not be allocated (the pool must not be used)
+
+private:
+	// Private Members (aligned buffers, allocated once, channel planes are contiguous)
+	int					width_;
+	int					height_;
+	int					num_chans_;
+	int					num_buffers_;
+	size_t				buffer_floats_;
+	std::vector<float*>	buffers_;
+	std::vector<int>	refs_;			// References to each buffer (the latest buffer also holds one for the pool)
+	std::vector<long long>	sequence_;
+	std::vector<double>	timestamp_;
+	int					latest_ = -1;
+	long long			next_sequence_ = 0;
+	long long			frames_dropped_ = 0;
+	bool				allocated_ = true;
+	std::mutex			pool_mutex_;
+
+	// Private Methods
+	void		Unref(int slot);
+};
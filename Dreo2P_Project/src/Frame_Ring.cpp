@@ -0,0 +1,150 @@
+// Dreo2P Frame Ring Class (source)
+#include "Frame_Ring.h"
+
+// Constructor (publisher)
+Frame_Ring::Frame_Ring(std::string name, int num_slots, int width, int height, int num_chans)
+{
+	// Slot size (header and channel planes, whole pages)
+	num_slots = std::max(2, num_slots);
+	long long frame_bytes = (long long)width * height * num_chans * sizeof(float);
+	long long slot_bytes = ((frame_slot_header_bytes + frame_bytes + 4095) / 4096) * 4096;
+
+	// Map the ring
+	memory_ = new Shared_Memory(name, (size_t)(frame_ring_header_bytes + num_slots * slot_bytes), true);
+	if (!memory_->Is_Open()) { return; }
+	header_ = (Frame_Ring_Header*)memory_->Data();
+	slots_ = (char*)memory_->Data() + frame_ring_header_bytes;
+
+	// Write the header (no frames yet, every slot empty)
+	header_->frames_published.store(0, std::memory_order_relaxed);
+	for (int s = 0; s < num_slots; s++)
+	{
+		Frame_Slot_Header* slot = (Frame_Slot_Header*)(slots_ + s * slot_bytes);
+		slot->state.store(0, std::memory_order_relaxed);
+	}
+	header_->version = frame_ring_version;
+	header_->num_slots = num_slots;
+	header_->width = width;
+	header_->height = height;
+	header_->num_chans = num_chans;
+	header_->slot_bytes = slot_bytes;
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(header_->magic, "D2P_RNG", 8);
+}
+
+
+// Constructor (client)
+Frame_Ring::Frame_Ring(std::string name)
+{
+	// Map the ring (read only) and check its layout
+	memory_ = new Shared_Memory(name, 0, false);
+	if (!memory_->Is_Open() || (memory_->Size() < (size_t)frame_ring_header_bytes)) { return; }
+	Frame_Ring_Header* header = (Frame_Ring_Header*)memory_->Data();
+	if ((strcmp(header->magic, "D2P_RNG") != 0) || (header->version != frame_ring_version)) { return; }
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (memory_->Size() < (size_t)(frame_ring_header_bytes + header->num_slots * header->slot_bytes)) { return; }
+	header_ = header;
+	slots_ = (char*)memory_->Data() + frame_ring_header_bytes;
+}
+
+
+// Destructor
+Frame_Ring::~Frame_Ring()
+{
+	Close();
+}
+
+
+// Is the ring mapped?
+bool Frame_Ring::Is_Open()
+{
+	return (header_ != NULL);
+}
+
+
+// Write the next frame (into the oldest slot, readers still using it will find it invalid)
+void Frame_Ring::Publish(const float* frames, double timestamp)
+{
+	if (header_ == NULL) { return; }
+	long long sequence = header_->frames_published.load(std::memory_order_relaxed);
+	Frame_Slot_Header* slot = Slot(sequence);
+	float* data = (float*)((char*)slot + frame_slot_header_bytes);
+
+	// Mark slot as being written
+	slot->state.store(2 * sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	// Copy the planes of every channel
+	size_t samples = (size_t)header_->width * header_->height * header_->num_chans;
+	std::copy(frames, frames + samples, data);
+	slot->sequence = sequence;
+	slot->timestamp = timestamp;
+
+	// Mark slot as complete and count the frame
+	slot->state.store(2 * sequence + 2, std::memory_order_release);
+	header_->frames_published.store(sequence + 1, std::memory_order_release);
+}
+
+
+// Number of frames published (the latest is one less)
+long long Frame_Ring::Frames_Published()
+{
+	if (header_ == NULL) { return 0; }
+	return header_->frames_published.load(std::memory_order_acquire);
+}
+
+
+// Oldest readable frame (the slot after the latest is the next one overwritten, so it is not counted)
+long long Frame_Ring::Oldest_Sequence()
+{
+	if (header_ == NULL) { return 0; }
+	return std::max(0LL, Frames_Published() - (header_->num_slots - 1));
+}
+
+
+// Get a frame in place
+bool Frame_Ring::Read(long long sequence, Frame_Ring_View* view)
+{
+	if ((header_ == NULL) || (sequence < 0)) { return false; }
+	Frame_Slot_Header* slot = Slot(sequence);
+	if (slot->state.load(std::memory_order_acquire) != (2 * sequence + 2)) { return false; }
+	view->data = (const float*)((char*)slot + frame_slot_header_bytes);
+	view->width = header_->width;
+	view->height = header_->height;
+	view->num_chans = header_->num_chans;
+	view->sequence = sequence;
+	view->timestamp = slot->timestamp;
+	return Is_Valid(sequence);
+}
+
+
+// Check that a frame is still in its slot
+bool Frame_Ring::Is_Valid(long long sequence)
+{
+	if ((header_ == NULL) || (sequence < 0)) { return false; }
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return (Slot(sequence)->state.load(std::memory_order_relaxed) == (2 * sequence + 2));
+}
+
+
+// Unmap the ring
+void Frame_Ring::Close()
+{
+	if (memory_ != NULL)
+	{
+		memory_->Close();
+		delete memory_;
+		memory_ = NULL;
+	}
+	header_ = NULL;
+	slots_ = NULL;
+}
+
+
+// Slot header of a frame
+Frame_Slot_Header* Frame_Ring::Slot(long long sequence)
+{
+	return (Frame_Slot_Header*)(slots_ + (sequence % header_->num_slots) * header_->slot_bytes);
+}
+
+// FIN
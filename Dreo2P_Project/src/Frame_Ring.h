@@ -0,0 +1,81 @@
+// Dreo2P Frame Ring Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+
+// Inlcude Local Headers
+#include "Shared_Memory.h"
+
+// Frame ring layout version (increment when the layout changes)
+static const int	frame_ring_version = 1;
+static const int	frame_ring_header_bytes = 4096;
+static const int	frame_slot_header_bytes = 64;
+
+// Shared memory layout:
+// - ring header (frame_ring_header_bytes)
+// - num_slots slots (slot_bytes apart, page aligned), each a slot header (frame_slot_header_bytes) followed by the channel planes (float32, row major)
+// Frame n is written to slot n % num_slots. A slot's state is odd (2n + 1) while frame n is written, and even (2n + 2) once it is complete.
+// Readers never write: they check the state before and after using a frame in place, and drop it (and catch up) if the writer has reused the slot.
+struct Frame_Ring_Header
+{
+	char					magic[8];		// "D2P_RNG"
+	int						version;
+	int						num_slots;
+	int						width;
+	int						height;
+	int						num_chans;
+	int						reserved;
+	long long				slot_bytes;
+	std::atomic<long long>	frames_published;	// Sequence number of the next frame
+};
+
+struct Frame_Slot_Header
+{
+	std::atomic<long long>	state;
+	long long				sequence;
+	double					timestamp;		// Seconds since the scanner was initialized
+};
+
+// A frame read in place from the ring
+struct Frame_Ring_View
+{
+	const float*	data;			// Channel planes (num_chans * width * height)
+	int				width;
+	int				height;
+	int				num_chans;
+	long long		sequence;
+	double			timestamp;
+};
+
+// Publishes (scanner) or reads (clients in other processes) a ring of frames
+class Frame_Ring
+{
+public:
+	// Constructors
+	Frame_Ring(std::string name, int num_slots, int width, int height, int num_chans);	// Publisher
+	Frame_Ring(std::string name);															// Client
+
+	// Destructors
+	~Frame_Ring();
+
+	// Public Methods
+	bool		Is_Open();
+	void		Publish(const float* frames, double timestamp);	// Single writer (planes of all channels)
+	long long	Frames_Published();
+	long long	Oldest_Sequence();					// Oldest frame that can still be read
+	bool		Read(long long sequence, Frame_Ring_View* view);	// In place (false if not yet published or already overwritten)
+	bool		Is_Valid(long long sequence);		// Frame was not overwritten while in use (check after processing a view)
+	void		Close();
+
+private:
+	// Private Members
+	Shared_Memory*		memory_ = NULL;
+	Frame_Ring_Header*	header_ = NULL;
+	char*				slots_ = NULL;
+
+	// Private Methods
+	Frame_Slot_Header*	Slot(long long sequence);
+};
@@ -0,0 +1,70 @@
+// Dreo2P Latency Histogram Class (source)
+#include "Latency_Histogram.h"
+
+// Constructor
+Latency_Histogram::Latency_Histogram()
+{
+	Reset();
+}
+
+
+// Destructor
+Latency_Histogram::~Latency_Histogram()
+{
+}
+
+
+// Summarize the recorded latencies (microseconds), percentiles at the centre of their bin
+Stage_Stats Latency_Histogram::Stats()
+{
+	Stage_Stats stats;
+	unsigned long long count = count_.load(std::memory_order_relaxed);
+	stats.count = (long long)count;
+	stats.mean = (count > 0) ? Tsc_Clock::To_Microseconds((double)total_ticks_.load(std::memory_order_relaxed) / count) : 0.0;
+	stats.max = Tsc_Clock::To_Microseconds((double)max_ticks_.load(std::memory_order_relaxed));
+
+	// Walk bins up to each percentile
+	double percentiles[3] = { 0.5, 0.99, 0.999 };
+	double* values[3] = { &stats.p50, &stats.p99, &stats.p999 };
+	for (int p = 0; p < 3; p++)
+	{
+		*values[p] = 0.0;
+		unsigned long long target = (unsigned long long)(percentiles[p] * count);
+		unsigned long long seen = 0;
+		for (int b = 0; b < histogram_bins; b++)
+		{
+			seen += bins_[b].load(std::memory_order_relaxed);
+			if ((seen > target) && (count > 0))
+			{
+				*values[p] = std::min(Tsc_Clock::To_Microseconds(Bin_Ticks(b)), stats.max);
+				break;
+			}
+		}
+	}
+	return stats;
+}
+
+
+// Clear all counts
+void Latency_Histogram::Reset()
+{
+	for (int b = 0; b < histogram_bins; b++)
+	{
+		bins_[b].store(0, std::memory_order_relaxed);
+	}
+	count_.store(0, std::memory_order_relaxed);
+	total_ticks_.store(0, std::memory_order_relaxed);
+	max_ticks_.store(0, std::memory_order_relaxed);
+}
+
+
+// Centre of a bin (ticks)
+double Latency_Histogram::Bin_Ticks(int bin)
+{
+	if (bin < 4) { return (double)bin; }
+	int msb = (bin / 4) + 1;
+	double width = ldexp(1.0, msb - 2);
+	return (((4 + (bin % 4)) * width) + (0.5 * width));
+}
+
+// FIN
@@ -0,0 +1,92 @@
+// Dreo2P Latency Histogram Class (header)
+#pragma once
+// Include STD headers
+#include <atomic>
+#include <algorithm>
+#include <math.h>
+
+// Inlcude Local Headers
+#include "Tsc_Clock.h"
+
+// Instrumented pipeline stages
+enum Pipeline_Stage
+{
+	STAGE_READ,				// Sample source read (DAQ, replay, phantom or simulated)
+	STAGE_BIN,				// Binning a scan line (first frame of a group)
+	STAGE_AVERAGE,			// Binning and averaging a scan line (later frames of a group)
+	STAGE_DISPLAY_COPY,		// Copying the binned frame to the idle display buffer
+	STAGE_QUEUE,			// Queueing averaged frames for the writer
+	STAGE_WRITE,			// Writing queued frames to disk (writer thread)
+	STAGE_UPLOAD,			// Uploading the display frame texture (display thread)
+	STAGE_RENDER,			// Rendering and swapping the display window (display thread)
+	STAGE_WAKE				// Lateness of the scanner thread waking from its pacing sleep (scheduling jitter)
+};
+static const int	num_pipeline_stages = 9;
+
+// Latency summary of a stage (microseconds)
+struct Stage_Stats
+{
+	long long	count;
+	double		mean;
+	double		p50;
+	double		p99;
+	double		p999;
+	double		max;
+};
+
+// Latency summary of every stage (the layout returned by the DLL)
+struct Pipeline_Stats
+{
+	Stage_Stats	stages[num_pipeline_stages];
+};
+
+// Log spaced bins (4 per octave) of a 64-bit tick count
+static const int	histogram_bins = 256;
+
+// Lock-free latency histogram (one recording thread, any number of readers)
+class Latency_Histogram
+{
+public:
+	// Constructors
+	Latency_Histogram();
+
+	// Destructors
+	~Latency_Histogram();
+
+	// Public Methods
+	void		Record(unsigned long long ticks);
+	Stage_Stats	Stats();
+	void		Reset();
+
+private:
+	// Private Members (relaxed counters)
+	std::atomic<unsigned long long>	bins_[histogram_bins];
+	std::atomic<unsigned long long>	count_;
+	std::atomic<unsigned long long>	total_ticks_;
+	std::atomic<unsigned long long>	max_ticks_;
+
+	// Private Methods
+	static int		Bin(unsigned long long ticks);
+	static double	Bin_Ticks(int bin);
+};
+
+// Count a measurement (inline, called around every stage)
+inline void Latency_Histogram::Record(unsigned long long ticks)
+{
+	bins_[Bin(ticks)].fetch_add(1, std::memory_order_relaxed);
+	count_.fetch_add(1, std::memory_order_relaxed);
+	total_ticks_.fetch_add(ticks, std::memory_order_relaxed);
+	if (ticks > max_ticks_.load(std::memory_order_relaxed))
+	{
+		max_ticks_.store(ticks, std::memory_order_relaxed);
+	}
+}
+
+// Bin of a tick count: exact below 4, then 4 bins per power of two
+inline int Latency_Histogram::Bin(unsigned long long ticks)
+{
+	if (ticks < 4) { return (int)ticks; }
+	int msb = 63;
+	while ((ticks >> msb) == 0) { msb--; }
+	return ((msb - 1) * 4) + (int)((ticks >> (msb - 2)) & 3);
+}
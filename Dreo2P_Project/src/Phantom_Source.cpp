@@ -0,0 +1,257 @@
+// Dreo2P Phantom Source Class (source)
+#include "Phantom_Source.h"
+
+// Constructor
+Phantom_Source::Phantom_Source(
+	const double*	scan_waveform,
+	int				x_pixels,
+	int				y_pixels,
+	int				pixels_per_line,
+	int				bin_factor,
+	double			input_rate,
+	double			amplitude,
+	double			y_offset,
+	int				num_chans,
+	const std::vector<float>& volume,
+	int				width,
+	int				height,
+	Phantom_Options	options,
+	bool			paced)
+{
+	// Set scan parameters (keep a copy of the X and Y waveform)
+	x_pixels_ = x_pixels;
+	y_pixels_ = y_pixels;
+	pixels_per_line_ = pixels_per_line;
+	pixels_per_scan_ = pixels_per_line * y_pixels;
+	bin_factor_ = bin_factor;
+	input_rate_ = input_rate;
+	amplitude_ = amplitude;
+	y_offset_ = y_offset;
+	num_chans_ = std::min(num_chans, raw_max_chans);
+	scan_waveform_.assign(scan_waveform, scan_waveform + ((size_t)pixels_per_scan_ * 2));
+
+	// Set ground truth (a blank plane if empty)
+	volume_ = volume;
+	width_ = width;
+	height_ = height;
+	num_planes_ = ((width > 0) && (height > 0)) ? (int)(volume.size() / ((size_t)width * height)) : 0;
+	if (num_planes_ == 0)
+	{
+		width_ = 1;
+		height_ = 1;
+		num_planes_ = 1;
+		volume_.assign(1, 0.0f);
+	}
+
+	// Set detector model (samples are quantized as by a +/-10 V, 16-bit ADC)
+	options_ = options;
+	lag_samples_ = options.mirror_lag * input_rate;
+	pulse_retain_ = (options.pulse_decay > 0.0) ? exp(-1.0 / (options.pulse_decay * input_rate)) : 0.0;
+	volts_per_count_ = 20.0 / 65536.0;
+	random_.seed(options.seed);
+	uniform_ = std::uniform_real_distribution<double>(0.0, 1.0);
+	normal_ = std::normal_distribution<double>(0.0, 1.0);
+	paced_ = paced;
+}
+
+
+// Destructor
+Phantom_Source::~Phantom_Source()
+{
+}
+
+
+// Start a scan group (mirrors start from the beginning of the scan waveform)
+int Phantom_Source::Start()
+{
+	sample_ = 0;
+	for (int c = 0; c < raw_max_chans; c++)
+	{
+		pulse_[c] = 0.0;
+	}
+	start_time_ = std::chrono::steady_clock::now();
+	return 0;
+}
+
+
+// Synthesize num_scans (-1 = all due, or max_scans if not paced), also as int16 if raw is not NULL
+int Phantom_Source::Read(int num_scans, double* volts, short* raw, int max_scans)
+{
+	// How many scans? (a fixed number waits until they are due, if paced)
+	long long count;
+	if (num_scans < 0)
+	{
+		count = paced_ ? (Scans_Due() - sample_) : max_scans;
+	}
+	else
+	{
+		count = num_scans;
+		while (paced_ && ((Scans_Due() - sample_) < count))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	count = std::max(0LL, std::min(count, (long long)max_scans));
+
+	// Synthesize int16 samples (into the caller's buffer, if given)
+	short* samples = raw;
+	if (samples == NULL)
+	{
+		if (raw_buffer_.size() < (size_t)max_scans * num_chans_) { raw_buffer_.resize((size_t)max_scans * num_chans_); }	// Grows once, not while scanning
+		samples = raw_buffer_.data();
+	}
+	for (long long s = 0; s < count; s++)
+	{
+		// Mirror position (the command, delayed by the mirror lag, interpolated between pixel updates)
+		double pixel = std::max(0.0, (double)(sample_ + s) - lag_samples_) / bin_factor_;
+		long long whole_pixel = (long long)pixel;
+		double fraction = pixel - (double)whole_pixel;
+		int plane = (int)((whole_pixel / pixels_per_scan_) % num_planes_);
+		int this_pixel = (int)(whole_pixel % pixels_per_scan_);
+		int next_pixel = (this_pixel + 1) % pixels_per_scan_;
+		double x = (scan_waveform_[this_pixel * 2] * (1.0 - fraction)) + (scan_waveform_[next_pixel * 2] * fraction);
+		double y = (scan_waveform_[(this_pixel * 2) + 1] * (1.0 - fraction)) + (scan_waveform_[(next_pixel * 2) + 1] * fraction);
+		double brightness = Brightness(plane, x, y);
+
+		// Detector signal (Poisson photons, exponential PMT pulses, offset and electronic noise)
+		for (int c = 0; c < num_chans_; c++)
+		{
+			int photons = Photons(options_.photon_rate * options_.channel_gain[c] * brightness);
+			pulse_[c] = (pulse_[c] * pulse_retain_) + (photons * options_.pulse_amplitude);
+			double signal = options_.offset + pulse_[c] + (options_.noise * normal_(random_));
+			double counts = floor((signal / volts_per_count_) + 0.5);
+			samples[(s * num_chans_) + c] = (short)std::max(-32768.0, std::min(32767.0, counts));
+		}
+	}
+	sample_ += count;
+
+	// Scale to volts (as the device would)
+	double scaling_coeffs[raw_max_chans][4];
+	Scaling_Coeffs(scaling_coeffs);
+	Raw_Recorder::Scale_Samples(samples, volts, (int)count, num_chans_, scaling_coeffs);
+	return (int)count;
+}
+
+
+// Nothing to stop
+int Phantom_Source::Stop()
+{
+	return 0;
+}
+
+
+// Are samples delivered at the input rate?
+bool Phantom_Source::Is_Paced()
+{
+	return paced_;
+}
+
+
+// The phantom never runs out of samples
+bool Phantom_Source::Is_Finished()
+{
+	return false;
+}
+
+
+// Scans due but not yet read (if paced)
+long long Phantom_Source::Backlog()
+{
+	return paced_ ? std::max(0LL, Scans_Due() - sample_) : 0;
+}
+
+
+// Synthesized samples are never lost
+long long Phantom_Source::Scans_Dropped()
+{
+	return 0;
+}
+
+
+// Samples per scan
+int Phantom_Source::Num_Chans()
+{
+	return num_chans_;
+}
+
+
+// Number of ground truth planes (frame n scans plane n % Num_Planes)
+int Phantom_Source::Num_Planes()
+{
+	return num_planes_;
+}
+
+
+// Expected binned pixel values (volts) of a plane: mean signal at the commanded pixel positions, without noise or mirror lag
+void Phantom_Source::Ground_Truth(int plane, int channel, float* frame)
+{
+	double volts_per_brightness = options_.photon_rate * options_.channel_gain[channel] * options_.pulse_amplitude / (1.0 - pulse_retain_);
+	for (int j = 0; j < y_pixels_; j++)
+	{
+		for (int i = 0; i < x_pixels_; i++)
+		{
+			int pixel = (j * pixels_per_line_) + i;
+			double brightness = Brightness(plane % num_planes_, scan_waveform_[pixel * 2], scan_waveform_[(pixel * 2) + 1]);
+			frame[(j * x_pixels_) + i] = (float)(options_.offset + (volts_per_brightness * brightness));
+		}
+	}
+}
+
+
+// Device scaling of the synthesized int16 samples (linear)
+void Phantom_Source::Scaling_Coeffs(double scaling_coeffs[][4])
+{
+	for (int c = 0; c < raw_max_chans; c++)
+	{
+		scaling_coeffs[c][0] = 0.0;
+		scaling_coeffs[c][1] = volts_per_count_;
+		scaling_coeffs[c][2] = 0.0;
+		scaling_coeffs[c][3] = 0.0;
+	}
+}
+
+
+// Ground truth brightness at a mirror position (the volume fills the forward scan, dark outside)
+double Phantom_Source::Brightness(int plane, double x_volts, double y_volts)
+{
+	int u = (int)floor(((x_volts + amplitude_) / (2.0 * amplitude_)) * width_);
+	int v = (int)floor(((y_volts - y_offset_ + amplitude_) / (2.0 * amplitude_)) * height_);
+	if ((u < 0) || (u >= width_) || (v < 0) || (v >= height_))
+	{
+		return 0.0;
+	}
+	return volume_[((size_t)plane * width_ * height_) + ((size_t)v * width_) + u];
+}
+
+
+// Draw a Poisson photon count (by inversion for small means, normal approximation for large)
+int Phantom_Source::Photons(double mean)
+{
+	if (mean <= 0.0)
+	{
+		return 0;
+	}
+	if (mean > 30.0)
+	{
+		return std::max(0, (int)floor(mean + (sqrt(mean) * normal_(random_)) + 0.5));
+	}
+	double limit = exp(-mean);
+	double product = uniform_(random_);
+	int photons = 0;
+	while (product > limit)
+	{
+		product *= uniform_(random_);
+		photons++;
+	}
+	return photons;
+}
+
+
+// Scans that the device would have acquired since the scan group started
+long long Phantom_Source::Scans_Due()
+{
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+	return (long long)(elapsed * input_rate_);
+}
+
+// FIN
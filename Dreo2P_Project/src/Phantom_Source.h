@@ -0,0 +1,105 @@
+// Dreo2P Phantom Source Class (header)
+#pragma once
+// Include STD headers
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <math.h>
+
+// Inlcude Local Headers
+#include "Sample_Source.h"
+#include "Raw_Recorder.h"
+
+// Detector and mirror model of a synthetic PMT stream
+struct Phantom_Options
+{
+	double		photon_rate = 0.05;			// Mean photons per sample at unit brightness
+	double		pulse_amplitude = 0.02;		// Peak PMT pulse per photon (volts)
+	double		pulse_decay = 200e-9;		// PMT pulse (and preamp) decay time constant (seconds)
+	double		offset = -0.002;			// Detector offset (volts)
+	double		noise = 0.0005;				// Electronic noise (volts rms)
+	double		mirror_lag = 100e-6;		// Mirror position lags the command by (seconds)
+	int			num_chans = 2;				// Detector channels (up to raw_max_chans)
+	double		channel_gain[raw_max_chans] = { 1.0, 0.5, 0.25, 0.125 };	// Brightness of the volume seen by each channel
+	unsigned	seed = 1;
+};
+
+// Synthesizes interleaved PMT samples by scanning a ground-truth volume (one plane per frame, cycling) with the scan waveform
+class Phantom_Source : public Sample_Source
+{
+public:
+	// Constructors
+	Phantom_Source(	const double*	scan_waveform,
+					int				x_pixels,
+					int				y_pixels,
+					int				pixels_per_line,
+					int				bin_factor,
+					double			input_rate,
+					double			amplitude,
+					double			y_offset,
+					int				num_chans,
+					const std::vector<float>& volume,
+					int				width,
+					int				height,
+					Phantom_Options	options,
+					bool			paced);
+
+	// Destructors
+	~Phantom_Source();
+
+	// Public Methods
+	int		Start();
+	int		Read(int num_scans, double* volts, short* raw, int max_scans);
+	int		Stop();
+	bool	Is_Paced();
+	bool	Is_Finished();
+	long long	Backlog();
+	long long	Scans_Dropped();
+	int			Num_Chans();
+	int		Num_Planes();
+	void	Ground_Truth(int plane, int channel, float* frame);		// Noise and lag free (mean) binned pixel values (volts)
+	void	Scaling_Coeffs(double scaling_coeffs[][4]);				// Device scaling of the synthesized int16 samples
+
+private:
+	// Private Members (scan)
+	std::vector<double>	scan_waveform_;
+	int					x_pixels_;
+	int					y_pixels_;
+	int					pixels_per_line_;
+	int					pixels_per_scan_;
+	int					bin_factor_;
+	double				input_rate_;
+	double				amplitude_;
+	double				y_offset_;
+	int					num_chans_;
+
+	// Private Members (ground truth, relative brightness)
+	std::vector<float>	volume_;
+	int					width_;
+	int					height_;
+	int					num_planes_;
+
+	// Private Members (detector model)
+	Phantom_Options		options_;
+	double				lag_samples_;
+	double				pulse_retain_;						// Pulse remaining after one sample
+	double				pulse_[raw_max_chans];				// Current pulse height on each channel
+	double				volts_per_count_;
+	std::mt19937		random_;
+	std::uniform_real_distribution<double>	uniform_;
+	std::normal_distribution<double>		normal_;
+	std::vector<short>	raw_buffer_;
+
+	// Private Members (timing)
+	bool				paced_;
+	long long			sample_ = 0;						// Scans generated in this scan group
+	std::chrono::steady_clock::time_point	start_time_;
+
+	// Private Methods
+	double	Brightness(int plane, double x_volts, double y_volts);
+	int		Photons(double mean);
+	long long	Scans_Due();
+};
@@ -0,0 +1,171 @@
+// Dreo2P Pretrigger Buffer Class (source)
+#include "Pretrigger_Buffer.h"
+
+// Constructor
+Pretrigger_Buffer::Pretrigger_Buffer(std::string path, int frame_width, int frame_height, int num_chans, int capacity, Writer_Options options)
+{
+	// Set parameters
+	path_ = path;
+	frame_width_ = frame_width;
+	frame_height_ = frame_height;
+	num_chans_ = num_chans;
+	capacity_ = std::max(1, capacity);
+	options_ = options;
+
+	// Make space for frames (allocated once, filled during live scanning)
+	frames_.resize(capacity_);
+	for (int i = 0; i < capacity_; i++)
+	{
+		frames_[i].resize((size_t)frame_width_ * frame_height_ * num_chans_);
+	}
+	sequence_.resize(capacity_, -1);
+
+	// Start the dump thread
+	active_ = true;
+	dump_thread_ = std::thread(&Pretrigger_Buffer::Dump_Thread_Function, this);
+}
+
+
+// Destructor
+Pretrigger_Buffer::~Pretrigger_Buffer()
+{
+}
+
+
+// Dump thread function
+void Pretrigger_Buffer::Dump_Thread_Function()
+{
+	// Dump buffered frames for each request until closed
+	int dump_number = 0;
+	while (true)
+	{
+		// Wait for a request
+		{
+			std::unique_lock<std::mutex> lock(ring_mutex_);
+			dump_signal_.wait(lock, [this] { return (dump_requests_ > 0) || !active_; });
+			if (dump_requests_ == 0) { break; }
+			dumping_ = true;
+		}
+
+		// Write buffered frames to a new stack
+		Dump(dump_number);
+		dump_number++;
+		dumps_completed_++;
+
+		// Request done
+		{
+			std::lock_guard<std::mutex> lock(ring_mutex_);
+			dump_requests_--;
+			dumping_ = false;
+		}
+	}
+}
+
+
+// Keep an averaged frame (overwrites the oldest, never waits for the disk)
+void Pretrigger_Buffer::Push(const float* frames)
+{
+	std::lock_guard<std::mutex> lock(ring_mutex_);
+	int slot = (int)(next_sequence_ % capacity_);
+	std::copy(frames, frames + frames_[slot].size(), frames_[slot].begin());
+	sequence_[slot] = next_sequence_;
+	next_sequence_++;
+}
+
+
+// Request a dump of the buffered frames (acquisition continues, the dump runs on its own thread)
+void Pretrigger_Buffer::Trigger()
+{
+	{
+		std::lock_guard<std::mutex> lock(ring_mutex_);
+		dump_requests_++;
+	}
+	dump_signal_.notify_one();
+}
+
+
+// Number of frames kept
+int Pretrigger_Buffer::Capacity()
+{
+	return capacity_;
+}
+
+
+// Is a dump being written?
+bool Pretrigger_Buffer::Is_Dumping()
+{
+	return dumping_;
+}
+
+
+// Number of dumps written
+int Pretrigger_Buffer::Dumps_Completed()
+{
+	return dumps_completed_;
+}
+
+
+// Number of frames overwritten by live frames before they were dumped
+int Pretrigger_Buffer::Frames_Lost()
+{
+	return frames_lost_;
+}
+
+
+// Stop thread (after writing requested dumps)
+void Pretrigger_Buffer::Close()
+{
+	if (active_)
+	{
+		{
+			std::lock_guard<std::mutex> lock(ring_mutex_);
+			active_ = false;
+		}
+		dump_signal_.notify_one();
+		dump_thread_.join();
+	}
+}
+
+
+// Write the frames buffered at the time of the request, oldest first
+void Pretrigger_Buffer::Dump(int dump_number)
+{
+	// Which frames were buffered?
+	long long first;
+	long long last;
+	{
+		std::lock_guard<std::mutex> lock(ring_mutex_);
+		last = next_sequence_;
+		first = std::max(0LL, last - capacity_);
+	}
+	int num_frames = (int)(last - first);
+	if (num_frames == 0) { return; }
+
+	// Start writer
+	std::string dump_path = path_ + "_pretrigger_" + std::to_string(dump_number);
+	Writer writer(dump_path, frame_width_, frame_height_, num_chans_, num_frames, num_frames, options_);
+
+	// Queue frames (copied under the lock, live frames may overwrite the oldest ones while we wait for the disk)
+	for (long long s = first; s < last; s++)
+	{
+		while (writer.Queue_Depth() >= options_.queue_length)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		std::lock_guard<std::mutex> lock(ring_mutex_);
+		int slot = (int)(s % capacity_);
+		if (sequence_[slot] == s)
+		{
+			writer.Write_Frames(frames_[slot].data());
+		}
+		else
+		{
+			frames_lost_++;
+		}
+	}
+
+	// Wait for all frames to reach the disk
+	writer.Close();
+}
+
+// FIN
@@ -0,0 +1,65 @@
+// Dreo2P Pretrigger Buffer Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <chrono>
+
+// Include Local Headers
+#include "Writer.h"
+
+// Memory limit for buffered frames (the buffer holds fewer frames if the requested duration would exceed it)
+static const double	pretrigger_max_bytes = 4.0 * 1024.0 * 1024.0 * 1024.0;
+
+class Pretrigger_Buffer
+{
+public:
+	// Constructors
+	Pretrigger_Buffer(std::string path, int frame_width, int frame_height, int num_chans, int capacity, Writer_Options options);
+
+	// Destructors
+	~Pretrigger_Buffer();
+
+	// Public Methods
+	void	Push(const float* frames);		// Keep an averaged frame of each channel (overwrites the oldest)
+	void	Trigger();					// Request a dump of the buffered frames (returns immediately)
+	int		Capacity();
+	bool	Is_Dumping();
+	int		Dumps_Completed();
+	int		Frames_Lost();				// Overwritten by live frames before they were dumped
+	void	Close();
+
+private:
+	// Private Members (frame ring, preallocated)
+	std::string			path_;
+	int					frame_width_;
+	int					frame_height_;
+	int					num_chans_;
+	int					capacity_;
+	Writer_Options		options_;
+	std::vector<std::vector<float>>	frames_;		// Planes of every channel
+	std::vector<long long>	sequence_;		// Sequence number of the frame in each slot (-1 = empty)
+	long long			next_sequence_ = 0;
+	std::mutex			ring_mutex_;
+
+	// Private Members (dump requests)
+	int					dump_requests_ = 0;
+	std::condition_variable	dump_signal_;
+	std::atomic<bool>	dumping_ = false;
+	std::atomic<int>	dumps_completed_ = 0;
+	std::atomic<int>	frames_lost_ = 0;
+
+	// Private Members (dump thread)
+	std::thread			dump_thread_;
+	std::atomic<bool>	active_ = false;
+
+	// Thread Function
+	void		Dump_Thread_Function();
+
+	// Private Methods
+	void		Dump(int dump_number);
+};
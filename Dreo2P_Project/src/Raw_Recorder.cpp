@@ -0,0 +1,217 @@
+// Dreo2P Raw Recorder Class (source)
+#include "Raw_Recorder.h"
+
+// Constructor
+Raw_Recorder::Raw_Recorder(std::string path, Raw_Header header, double max_duration)
+{
+	// Set header
+	header_ = header;
+	memcpy(header_.magic, "D2P_RAW", 8);
+	header_.version = raw_version;
+	header_.num_scans = 0;
+	header_.num_segments = 0;
+
+	// Make space for 2 seconds of samples (allocated once)
+	ring_scans_ = (int)(2.0 * header_.input_rate);
+	ring_.resize((size_t)ring_scans_ * header_.num_chans);
+
+	// Open file (bypassing the file cache) and preallocate space for the maximum recording duration, samples start after the (aligned) header
+	max_scans_ = (long long)(max_duration * header_.input_rate);
+	file_ = new Direct_Writer(path, raw_header_bytes + (max_scans_ * header_.num_chans * sizeof(short)), raw_header_bytes);
+
+	// Start the recorder thread
+	active_ = true;
+	recorder_thread_ = std::thread(&Raw_Recorder::Recorder_Thread_Function, this);
+}
+
+
+// Destructor
+Raw_Recorder::~Raw_Recorder()
+{
+	Close();
+	delete file_;
+}
+
+
+// Recorder thread function
+void Raw_Recorder::Recorder_Thread_Function()
+{
+	// Write recorded samples until closed (and the ring is empty)
+	while (true)
+	{
+		// Wait for samples (write the contiguous part of the ring up to its end)
+		int first_scan;
+		int num_scans;
+		{
+			std::unique_lock<std::mutex> lock(ring_mutex_);
+			ring_signal_.wait(lock, [this] { return (ring_count_ > 0) || !active_; });
+			if (ring_count_ == 0) { break; }
+			first_scan = ring_head_;
+			num_scans = std::min(ring_count_, ring_scans_ - ring_head_);
+		}
+
+		// Write samples to file (copied into the writer's buffers, so ring space is released before the disk write completes)
+		size_t bytes = (size_t)num_scans * header_.num_chans * sizeof(short);
+		file_->Append(&ring_[(size_t)first_scan * header_.num_chans], bytes);
+		scans_written_ += num_scans;
+
+		// Release ring space
+		{
+			std::lock_guard<std::mutex> lock(ring_mutex_);
+			ring_head_ = (ring_head_ + num_scans) % ring_scans_;
+			ring_count_ -= num_scans;
+		}
+	}
+}
+
+
+// Mark the start of a new scan group (the AI task restarted)
+void Raw_Recorder::Start_Segment()
+{
+	segments_.push_back({ scans_accepted_, 0 });
+	group_scans_ = 0;
+	dropping_ = false;
+}
+
+
+// Queue interleaved samples for writing, returns false (and drops them) if the ring or the file is full
+bool Raw_Recorder::Record(const short* samples, int num_scans)
+{
+	// Find free space (dropped samples end the segment, so readers can re-align lines when recording resumes)
+	int tail;
+	{
+		std::lock_guard<std::mutex> lock(ring_mutex_);
+		bool file_full = (max_scans_ > 0) && ((scans_accepted_ + num_scans) > max_scans_);
+		if (((ring_count_ + num_scans) > ring_scans_) || file_full)
+		{
+			scans_dropped_ += num_scans;
+			group_scans_ += num_scans;
+			dropping_ = true;
+			return false;
+		}
+		tail = (ring_head_ + ring_count_) % ring_scans_;
+	}
+
+	// Resume after dropped samples in a new segment (at the acquisition position of these samples in their scan group)
+	if (dropping_)
+	{
+		segments_.push_back({ scans_accepted_, group_scans_ });
+		dropping_ = false;
+	}
+	group_scans_ += num_scans;
+
+	// Copy samples into ring (wrapping at the end)
+	int first_part = std::min(num_scans, ring_scans_ - tail);
+	std::copy(samples, samples + ((size_t)first_part * header_.num_chans), &ring_[(size_t)tail * header_.num_chans]);
+	std::copy(samples + ((size_t)first_part * header_.num_chans), samples + ((size_t)num_scans * header_.num_chans), &ring_[0]);
+
+	// Publish samples to recorder thread
+	{
+		std::lock_guard<std::mutex> lock(ring_mutex_);
+		ring_count_ += num_scans;
+		scans_accepted_ += num_scans;
+	}
+	ring_signal_.notify_one();
+	return true;
+}
+
+
+// Number of scans written to file
+long long Raw_Recorder::Scans_Recorded()
+{
+	return scans_written_;
+}
+
+
+// Number of scans dropped (ring or file full)
+long long Raw_Recorder::Scans_Dropped()
+{
+	return scans_dropped_;
+}
+
+
+// Write throughput and latency
+Direct_Writer_Stats Raw_Recorder::Write_Stats()
+{
+	return file_->Stats();
+}
+
+
+// Scale raw (int16) interleaved samples to volts with each channel's device polynomial
+void Raw_Recorder::Scale_Samples(const short* raw, double* volts, int num_scans, int num_chans, const double scaling_coeffs[][4])
+{
+	for (int s = 0; s < num_scans; s++)
+	{
+		for (int c = 0; c < num_chans; c++)
+		{
+			double x = (double)raw[(s * num_chans) + c];
+			const double* k = scaling_coeffs[c];
+			volts[(s * num_chans) + c] = k[0] + (x * (k[1] + (x * (k[2] + (x * k[3])))));
+		}
+	}
+}
+
+
+// Read the segment table of a raw sample file (stored after the samples), ending with the end of the samples
+std::vector<Raw_Segment> Raw_Recorder::Read_Segments(std::ifstream& file, const Raw_Header& header)
+{
+	std::vector<Raw_Segment> segments(header.num_segments);
+	file.seekg(raw_header_bytes + (header.num_scans * header.num_chans * (long long)sizeof(short)));
+	if (header.version < 2)
+	{
+		// Version 1: first scan of each scan group only (no drops recorded)
+		std::vector<long long> first_scans(header.num_segments);
+		file.read((char*)first_scans.data(), first_scans.size() * sizeof(long long));
+		for (size_t s = 0; s < first_scans.size(); s++)
+		{
+			segments[s] = { first_scans[s], 0 };
+		}
+	}
+	else
+	{
+		file.read((char*)segments.data(), segments.size() * sizeof(Raw_Segment));
+	}
+	segments.push_back({ header.num_scans, 0 });
+	return segments;
+}
+
+
+// File index of the first scan in a segment acquired at phase (mod period) in its scan group, e.g. the start of the first full frame after dropped samples
+long long Raw_Recorder::Aligned_Scan(const Raw_Segment& segment, long long phase, long long period)
+{
+	long long periods = std::max(0LL, (segment.group_scan - phase + period - 1) / period);
+	return segment.first_scan + (phase + (periods * period)) - segment.group_scan;
+}
+
+
+// Stop thread (after writing all queued samples), write segment table and header, trim file
+void Raw_Recorder::Close()
+{
+	// End recorder thread (if active)
+	if (active_)
+	{
+		{
+			std::lock_guard<std::mutex> lock(ring_mutex_);
+			active_ = false;
+		}
+		ring_signal_.notify_one();
+		recorder_thread_.join();
+	}
+	if (closed_) { return; }
+	closed_ = true;
+
+	// Write segment table after the samples
+	file_->Append(segments_.data(), segments_.size() * sizeof(Raw_Segment));
+
+	// Write header
+	std::vector<char> header_block(raw_header_bytes, 0);
+	header_.num_scans = scans_written_;
+	header_.num_segments = (long long)segments_.size();
+	memcpy(header_block.data(), &header_, sizeof(header_));
+	file_->Write_At(0, header_block.data(), header_block.size());
+
+	// Wait for all writes, trim unused preallocated space and close
+	file_->Close();
+}
+
+// FIN
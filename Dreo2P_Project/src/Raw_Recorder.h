@@ -0,0 +1,100 @@
+// Dreo2P Raw Recorder Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// Include Local Headers
+#include "Direct_Writer.h"
+
+// Raw sample file layout:
+// - header (raw_header_bytes)
+// - interleaved int16 samples (one scan = one sample from each channel)
+// - segment table (a Raw_Segment for each scan group, i.e. each AI task start, and for each restart after dropped samples)
+static const int	raw_header_bytes = 4096;
+static const int	raw_max_chans = 4;
+static const int	raw_version = 2;		// Version 1 segment tables hold only the first scan of each scan group
+
+// Run of contiguous recorded scans
+struct Raw_Segment
+{
+	long long	first_scan;			// Index (in the file) of the first scan
+	long long	group_scan;			// Scans acquired in its scan group before the first scan (0 = a new scan group, otherwise samples were dropped)
+};
+
+// Raw sample file header (scan parameters needed to re-bin the samples)
+struct Raw_Header
+{
+	char		magic[8];			// "D2P_RAW"
+	int			version;
+	int			num_chans;
+	double		input_rate;
+	double		output_rate;
+	double		amplitude;
+	double		y_offset;
+	int			x_pixels;
+	int			y_pixels;
+	int			pixels_per_line;
+	int			bin_factor;
+	int			sample_shift;		// Samples discarded at the start of each segment by the live pipeline
+	int			frames_to_average;
+	double		scaling_coeffs[raw_max_chans][4];	// volts = c0 + c1*raw + c2*raw^2 + c3*raw^3 (per channel)
+	long long	num_scans;			// Scans recorded (written on close)
+	long long	num_segments;		// Segments recorded (written on close)
+};
+
+class Raw_Recorder
+{
+public:
+	// Constructors
+	Raw_Recorder(std::string path, Raw_Header header, double max_duration);
+
+	// Destructors
+	~Raw_Recorder();
+
+	// Public Methods
+	void		Start_Segment();
+	bool		Record(const short* samples, int num_scans);
+	long long	Scans_Recorded();
+	long long	Scans_Dropped();
+	Direct_Writer_Stats	Write_Stats();
+	static void	Scale_Samples(const short* raw, double* volts, int num_scans, int num_chans, const double scaling_coeffs[][4]);
+	static std::vector<Raw_Segment>	Read_Segments(std::ifstream& file, const Raw_Header& header);
+	static long long	Aligned_Scan(const Raw_Segment& segment, long long phase, long long period);
+	void		Close();
+
+private:
+	// Private Members (file, written with direct I/O)
+	Direct_Writer*		file_ = NULL;
+	Raw_Header			header_;
+	long long			max_scans_;			// Preallocated file capacity (scans)
+	std::vector<Raw_Segment>	segments_;
+	bool				closed_ = false;
+
+	// Private Members (sample ring, filled by the scanner thread and emptied by the recorder thread)
+	std::vector<short>	ring_;
+	int					ring_scans_;
+	int					ring_head_ = 0;
+	int					ring_count_ = 0;
+	std::mutex			ring_mutex_;
+	std::condition_variable	ring_signal_;
+	long long			scans_accepted_ = 0;
+	long long			group_scans_ = 0;		// Scans acquired (recorded or dropped) in this scan group
+	bool				dropping_ = false;		// Samples dropped since the last recorded read (the next one starts a new segment)
+	std::atomic<long long>	scans_written_ = 0;
+	std::atomic<long long>	scans_dropped_ = 0;
+
+	// Private Members (recorder thread)
+	std::thread			recorder_thread_;
+	std::atomic<bool>	active_ = false;
+
+	// Thread Function
+	void		Recorder_Thread_Function();
+};
@@ -0,0 +1,165 @@
+// Dreo2P Replay Source Class (source)
+#include "Replay_Source.h"
+
+// Constructor
+Replay_Source::Replay_Source(std::string path, bool paced)
+{
+	paced_ = paced;
+
+	// Read header
+	file_.open(path, std::ios::binary);
+	memset(&header_, 0, sizeof(header_));
+	file_.read((char*)&header_, sizeof(header_));
+	if (!file_ || (strcmp(header_.magic, "D2P_RAW") != 0) || (header_.num_chans < 1) || (header_.num_chans > raw_max_chans))
+	{
+		return;
+	}
+
+	// Read segment table (stored after the samples)
+	segments_ = Raw_Recorder::Read_Segments(file_, header_);
+	open_ = (bool)file_;
+}
+
+
+// Destructor
+Replay_Source::~Replay_Source()
+{
+	file_.close();
+}
+
+
+// Was a raw sample recording found?
+bool Replay_Source::Is_Open()
+{
+	return open_;
+}
+
+
+// Scan parameters of the recording
+Raw_Header Replay_Source::Header()
+{
+	return header_;
+}
+
+
+// Move to the next recorded segment (finished if there are none left)
+int Replay_Source::Start()
+{
+	segment_++;
+	if (!open_ || (segment_ >= header_.num_segments))
+	{
+		finished_ = true;
+		position_ = 0;
+		segment_end_ = 0;
+		return 0;
+	}
+
+	// Seek to the first scan of the segment (after dropped samples, to the first full set of averaged frames, so the scanner sees a line aligned scan group)
+	long long set_scans = (long long)header_.pixels_per_line * header_.bin_factor * header_.y_pixels * header_.frames_to_average;
+	position_ = Raw_Recorder::Aligned_Scan(segments_[segment_], 0, set_scans);
+	segment_end_ = segments_[segment_ + 1].first_scan;
+	file_.clear();
+	file_.seekg(raw_header_bytes + (position_ * header_.num_chans * (long long)sizeof(short)));
+
+	// Start the replay clock
+	delivered_ = 0;
+	finished_ = (position_ >= segment_end_);
+	start_time_ = std::chrono::steady_clock::now();
+	return 0;
+}
+
+
+// Read num_scans (-1 = all available), scaled to volts with the recorded device scaling
+int Replay_Source::Read(int num_scans, double* volts, short* raw, int max_scans)
+{
+	if (finished_) { return 0; }
+
+	// How many scans? (a fixed number waits until they are due, if paced)
+	long long count;
+	if (num_scans < 0)
+	{
+		count = paced_ ? (Scans_Due() - delivered_) : max_scans;
+	}
+	else
+	{
+		count = num_scans;
+		while (paced_ && ((Scans_Due() - delivered_) < count))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	count = std::max(0LL, std::min(count, std::min((long long)max_scans, segment_end_ - position_)));
+
+	// Read raw samples (into the caller's buffer, if given) and scale to volts
+	short* samples = raw;
+	if (samples == NULL)
+	{
+		if (raw_buffer_.size() < (size_t)max_scans * header_.num_chans) { raw_buffer_.resize((size_t)max_scans * header_.num_chans); }	// Grows once, not while replaying
+		samples = raw_buffer_.data();
+	}
+	file_.read((char*)samples, count * header_.num_chans * sizeof(short));
+	int num_read = (int)(file_.gcount() / (header_.num_chans * sizeof(short)));
+	Raw_Recorder::Scale_Samples(samples, volts, num_read, header_.num_chans, header_.scaling_coeffs);
+
+	// Advance (finished at the end of the segment, or of a truncated file)
+	position_ += num_read;
+	delivered_ += num_read;
+	if ((position_ >= segment_end_) || (num_read < count))
+	{
+		finished_ = true;
+	}
+	return num_read;
+}
+
+
+// Nothing to stop (the next Start moves on to the next segment)
+int Replay_Source::Stop()
+{
+	return 0;
+}
+
+
+// Are samples delivered at the recorded rate?
+bool Replay_Source::Is_Paced()
+{
+	return paced_;
+}
+
+
+// Has the segment (or the recording) run out of samples?
+bool Replay_Source::Is_Finished()
+{
+	return finished_;
+}
+
+
+// Scans due but not yet read (if paced)
+long long Replay_Source::Backlog()
+{
+	if (!paced_ || finished_) { return 0; }
+	return std::max(0LL, std::min(Scans_Due() - delivered_, segment_end_ - position_));
+}
+
+
+// Replayed samples are never lost
+long long Replay_Source::Scans_Dropped()
+{
+	return 0;
+}
+
+
+// Samples per scan
+int Replay_Source::Num_Chans()
+{
+	return header_.num_chans;
+}
+
+
+// Scans that the device would have acquired since the segment started
+long long Replay_Source::Scans_Due()
+{
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+	return (long long)(elapsed * header_.input_rate);
+}
+
+// FIN
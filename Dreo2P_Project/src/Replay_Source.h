@@ -0,0 +1,57 @@
+// Dreo2P Replay Source Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+
+// Inlcude Local Headers
+#include "Sample_Source.h"
+#include "Raw_Recorder.h"
+
+// Streams a raw sample recording, one recorded segment per scan group (samples dropped while recording also start a new scan group)
+class Replay_Source : public Sample_Source
+{
+public:
+	// Constructors
+	Replay_Source(std::string path, bool paced);
+
+	// Destructors
+	~Replay_Source();
+
+	// Public Methods
+	bool		Is_Open();
+	Raw_Header	Header();
+	int			Start();
+	int			Read(int num_scans, double* volts, short* raw, int max_scans);
+	int			Stop();
+	bool		Is_Paced();
+	bool		Is_Finished();
+	long long	Backlog();
+	long long	Scans_Dropped();
+	int			Num_Chans();
+
+private:
+	// Private Members (recording)
+	std::ifstream			file_;
+	Raw_Header				header_;
+	std::vector<Raw_Segment>	segments_;		// Each recorded segment (and the end of the last)
+	std::vector<short>		raw_buffer_;
+	bool					open_ = false;
+	bool					paced_;				// Deliver samples at the recorded input rate (otherwise as fast as possible)
+
+	// Private Members (replay position)
+	int						segment_ = -1;
+	long long				position_ = 0;
+	long long				segment_end_ = 0;
+	long long				delivered_ = 0;		// Scans delivered in this segment
+	bool					finished_ = true;
+	std::chrono::steady_clock::time_point	start_time_;
+
+	// Private Methods
+	long long	Scans_Due();
+};
@@ -0,0 +1,20 @@
+// Dreo2P Sample Source Interface (header)
+#pragma once
+
+// A source of interleaved analog input samples (one scan = one sample from each channel)
+class Sample_Source
+{
+public:
+	// Destructors
+	virtual ~Sample_Source() {}
+
+	// Public Methods
+	virtual int		Start() = 0;					// Start a scan group (returns 0, or a DAQmx error)
+	virtual int		Read(int num_scans, double* volts, short* raw, int max_scans) = 0;	// Read num_scans (-1 = all available), also as int16 if raw is not NULL (returns scans read, or a DAQmx error)
+	virtual int		Stop() = 0;						// Stop the scan group (returns 0, or a DAQmx error)
+	virtual bool	Is_Paced() = 0;					// Are samples delivered in real time? (otherwise as fast as they are read)
+	virtual bool	Is_Finished() = 0;				// Has the scan group run out of samples?
+	virtual long long	Backlog() = 0;				// Scans waiting to be read
+	virtual long long	Scans_Dropped() = 0;		// Scans lost before they were read (source overflow)
+	virtual int		Num_Chans() = 0;				// Samples per scan
+};
@@ -0,0 +1,131 @@
+// Dreo2P Scan Pattern Class (source)
+#include "Scan_Pattern.h"
+
+// Constructor: generate the X and Y voltages for a raster scan pattern (unidirectional)
+Scan_Pattern::Scan_Pattern(double amplitude, double y_offset, double input_rate, double output_rate, int x_pixels, int y_pixels)
+{
+	// Set scan parameters
+	amplitude_ = amplitude;
+	y_offset_ = y_offset;
+	input_rate_ = input_rate;
+	output_rate_ = output_rate;
+	x_pixels_ = x_pixels;
+	y_pixels_ = y_pixels;
+	bin_factor_ = (int)input_rate_ / (int)output_rate_;
+
+	// Number of backwards (return) pixels
+	int backward_pixels = (int)floor(output_rate_ / 1000.0); // minimum 1 millisecond return
+
+	// Compute forward scan velocity in volts/update (i.e. step size)
+	double forward_velocity = (2.0 * amplitude_) / x_pixels_;
+
+	// Compute overshoot pixels
+	int overshoot_pixels = floor( (12.5 *  ((2.0 * amplitude_) / 100.0)) / forward_velocity); // 12.5% amplitude overshoot
+	double overshoot_amplitude = amplitude_ + (forward_velocity * overshoot_pixels);
+
+	// Flyback (turn, backward, turn) from end of line to start of next line
+	flyback_pixels_ = overshoot_pixels + backward_pixels + overshoot_pixels;
+
+	// Compute the size of each scan segment: forward and flyback (turn, backward, turn)
+	pixels_per_line_ = x_pixels_ + flyback_pixels_;
+	pixels_per_scan_ = pixels_per_line_ * y_pixels_;
+	pixels_per_frame_ = x_pixels_ * y_pixels_;
+	samples_per_line_ = pixels_per_line_ * bin_factor_;
+	samples_per_scan_ = pixels_per_scan_ * bin_factor_;
+
+	// Create space for scan waveform (both X and Y values)
+	waveform_ = (double *)malloc(sizeof(double) * pixels_per_scan_ * 2.0);
+
+	// Perform Hermite blend interpolation from end of line to start of next line (into the X values of the first line's flyback, copied to every line)
+	double *flyback = &waveform_[2 * (x_pixels_ + overshoot_pixels)];
+	Hermite_Blend_Interpolate(backward_pixels, overshoot_amplitude, -overshoot_amplitude, forward_velocity, forward_velocity, flyback, 2);
+
+	// Fill array with scan positions (voltages)
+	int offset = 0;
+	for (size_t j = 0; j < y_pixels_; j++)
+	{
+		// Go from -amp to +amp in +velocity steps
+		for (size_t i = 0; i < x_pixels_; i++)
+		{
+			// X value
+			waveform_[offset] = (-1.0 * amplitude_) + (forward_velocity * i);
+			offset++;
+			// Y value
+			waveform_[offset] = y_offset_ + (-1.0 * amplitude_) + (forward_velocity * j);	// This may not make sense! (assumes X = Y)
+			offset++;
+		}
+		// Then go from +amp to +overshoot_amp in +velocity steps
+		for (size_t i = 0; i < overshoot_pixels; i++)
+		{
+			// X value
+			waveform_[offset] = amplitude_ + (forward_velocity * i);
+			offset++;
+			// Y value
+			waveform_[offset] = y_offset_ + (-1.0 * amplitude_) + (forward_velocity * j);	// This may not make sense! (assumes X = Y)
+			offset++;
+		}
+		// Then insert flyback from +overshoot_amp to -overshoot_amp
+		double current_velocity = forward_velocity;
+		double current_position = overshoot_amplitude;
+		for (size_t i = 0; i < backward_pixels; i++)
+		{
+			// X value
+			waveform_[offset] = flyback[2 * i];
+			offset++;
+			// Y value
+			waveform_[offset] = y_offset_ + (-1.0 * amplitude_) + (forward_velocity * j);	// This may not make sense! (assumes X = Y)
+			offset++;
+		}
+		// Then go from -overshoot_amp to -amp in +velocity steps
+		for (size_t i = 0; i < overshoot_pixels; i++)
+		{
+			// X value
+			waveform_[offset] = -overshoot_amplitude + (forward_velocity * i);
+			offset++;
+			// Y value
+			waveform_[offset] = y_offset_ + (-1.0 * amplitude_) + (forward_velocity * j);	// This may not make sense! (assumes X = Y)
+			offset++;
+		}
+	}
+}
+
+
+// Destructor
+Scan_Pattern::~Scan_Pattern()
+{
+	free(waveform_);
+}
+
+
+// Do the input and output rates give an integer number of samples per pixel?
+bool Scan_Pattern::Valid_Rates(double input_rate, double output_rate)
+{
+	return !((input_rate > output_rate) && ((int)input_rate % (int)output_rate != 0));
+}
+
+
+// Helper Function: Blend interpolation
+void Scan_Pattern::Hermite_Blend_Interpolate(int steps, double y1, double y2, double slope1, double slope2, double* curve, int stride)
+{
+	double next_y1 = y1;
+	double next_y2 = y2 + (-slope2 * steps);
+	for (size_t i = 0; i < steps; i++)
+	{
+		// Scale range from 0 to 1
+		double s = (double)i / double(steps);
+
+		// Compute Hermite basis functions
+		double h1 = (2.0 * s*s*s) - (3.0 * s*s) + 1.0;
+		double h2 = (-2.0 * s*s*s) + (3.0 * s*s);
+
+		// Compute interpolated point
+		double y = (h1 * next_y1) + (h2 * next_y2);
+		curve[i * stride] = y;
+
+		// Increment
+		next_y1 += slope1;
+		next_y2 += slope2;
+	}
+}
+
+// FIN
@@ -0,0 +1,41 @@
+// Dreo2P Scan Pattern Class (header)
+#pragma once
+// Include STD headers
+#include <stdlib.h>
+#include <math.h>
+
+// Raster scan pattern: X and Y mirror voltages for every pixel update (forward line, overshoot turn, flyback, overshoot turn)
+class Scan_Pattern
+{
+public:
+	// Constructors
+	Scan_Pattern(double amplitude, double y_offset, double input_rate, double output_rate, int x_pixels, int y_pixels);
+
+	// Destructors
+	~Scan_Pattern();
+
+	// Public Members (interleaved X and Y voltages, one pair per pixel of the scan)
+	double*	waveform_;
+
+	// Public Members (scan geometry)
+	int		bin_factor_;		// Ratio of samples per pixel (must be integer)
+	int		flyback_pixels_;
+	int		pixels_per_line_;
+	int		pixels_per_scan_;
+	int		pixels_per_frame_;
+	int		samples_per_line_;
+	int		samples_per_scan_;
+
+	// Public Methods
+	static bool		Valid_Rates(double input_rate, double output_rate);
+	static void		Hermite_Blend_Interpolate(int steps, double y1, double y2, double slope1, double slope2, double* curve, int stride = 1);	// Into the caller's buffer (every stride-th value)
+
+private:
+	// Private Members (scan parameters)
+	double	amplitude_;
+	double	y_offset_;
+	double	input_rate_;
+	double	output_rate_;
+	int		x_pixels_;
+	int		y_pixels_;
+};
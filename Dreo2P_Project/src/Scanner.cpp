@@ -3,16 +3,43 @@
 #include "Scanner.h"
 #define _SCL_SECURE_NO_WARNINGS  
 
+// Live scanners in this process
+std::mutex Scanner::instances_mutex_;
+std::vector<bool> Scanner::instances_live_;
+
 // Default constructor
 Scanner::Scanner()
 {
-
+	// Take the lowest free instance number (the first live scanner keeps the default telemetry name, others add their number)
+	{
+		std::lock_guard<std::mutex> lock(instances_mutex_);
+		instance_ = 0;
+		while ((instance_ < (int)instances_live_.size()) && instances_live_[instance_])
+		{
+			instance_++;
+		}
+		if (instance_ == (int)instances_live_.size())
+		{
+			instances_live_.push_back(true);
+		}
+		else
+		{
+			instances_live_[instance_] = true;
+		}
+	}
+	if (instance_ > 0)
+	{
+		telemetry_name_ = telemetry_name_ + "_" + std::to_string(instance_);
+	}
 };
 
 
 // Destructor
 Scanner::~Scanner()
 {
+	// Free the instance number (a later scanner reuses it, and its telemetry name)
+	std::lock_guard<std::mutex> lock(instances_mutex_);
+	instances_live_[instance_] = false;
 }
 
 // Initialize scanner (and start seperate thread)
@@ -40,28 +67,177 @@ void Scanner::Initialize(
 	// Initialize error
 	int status = 0;
 
+	// If replaying a raw recording, take the scan parameters (and device scaling) from its header
+	Replay_Source* replay_source = NULL;
+	if (replay_)
+	{
+		replay_source = new Replay_Source(replay_path_, replay_paced_);
+		if (!replay_source->Is_Open()) { Error_Handler(-1, "Replay file open"); }
+		Raw_Header header = replay_source->Header();
+		num_chans_			= header.num_chans;
+		amplitude_			= header.amplitude;
+		y_offset_			= header.y_offset;
+		input_rate_			= header.input_rate;
+		output_rate_		= header.output_rate;
+		x_pixels_			= header.x_pixels;
+		y_pixels_			= header.y_pixels;
+		frames_to_average_	= header.frames_to_average;
+		sample_shift_		= header.sample_shift;
+		memcpy(scaling_coeffs_, header.scaling_coeffs, sizeof(scaling_coeffs_));
+	}
+
 	// Generate scan pattern
 	Generate_Scan_Waveform();
 	//Save_Scan_Waveform("waveform.csv", scan_waveform_);
 
-	// Create and start digital output task (shutter controller)
-	DAQmxCreateTask("", &DO_taskHandle_);
-	DAQmxCreateDOChan(DO_taskHandle_, "Dev1/port0/line0", "", DAQmx_Val_ChanPerLine);
-	status = DAQmxStartTask(DO_taskHandle_);
-	if (status) { Error_Handler(status, "DO Task setup"); }
-
-	// Create analog input task
-	DAQmxCreateTask("", &AI_taskHandle_);
-	DAQmxCreateAIVoltageChan(AI_taskHandle_, "Dev1/ai0:1", "", DAQmx_Val_Cfg_Default, -10.0, 10.0, DAQmx_Val_Volts, NULL);
-	status = DAQmxCfgSampClkTiming(AI_taskHandle_, "", input_rate_, DAQmx_Val_Rising, DAQmx_Val_ContSamps, samples_per_scan_);
-	if (status) { Error_Handler(status, "AI Task setup"); }
-
-	// Create analog output task
-	DAQmxCreateTask("", &AO_taskHandle_);
-	DAQmxCreateAOVoltageChan(AO_taskHandle_, "Dev1/ao0:1", "", -10.0, 10.0, DAQmx_Val_Volts, NULL);
-	DAQmxCfgSampClkTiming(AO_taskHandle_, "", output_rate_, DAQmx_Val_Rising, DAQmx_Val_ContSamps, pixels_per_scan_);
-	status = DAQmxCfgDigEdgeStartTrig(AO_taskHandle_, "/Dev1/ai/StartTrigger", DAQmx_Val_Rising);
-	if (status) { Error_Handler(status, "AO Task setup"); }
+	// Create DAQ tasks (unless replaying, scanning a phantom or reading a caller provided source)
+	if (replay_)
+	{
+		source_ = replay_source;
+	}
+	else if (phantom_)
+	{
+		num_chans_ = phantom_options_.num_chans;
+		if ((num_chans_ < 1) || (num_chans_ > raw_max_chans)) { Error_Handler(-1, "Phantom channel count"); }
+		source_ = Create_Phantom_Source();
+	}
+	else if (external_source_ != NULL)
+	{
+		num_chans_ = external_source_->Num_Chans();
+		source_ = external_source_;
+	}
+	else
+	{
+		// Create and start digital output task (shutter controller, if any)
+		if (!shutter_line_.empty())
+		{
+			DAQmxCreateTask("", &DO_taskHandle_);
+			DAQmxCreateDOChan(DO_taskHandle_, (device_ + "/" + shutter_line_).c_str(), "", DAQmx_Val_ChanPerLine);
+			status = DAQmxStartTask(DO_taskHandle_);
+			if (status) { Error_Handler(status, "DO Task setup"); }
+		}
+
+		// Create analog input task
+		DAQmxCreateTask("", &AI_taskHandle_);
+		DAQmxCreateAIVoltageChan(AI_taskHandle_, (device_ + "/" + ai_channels_).c_str(), "", DAQmx_Val_Cfg_Default, -10.0, 10.0, DAQmx_Val_Volts, NULL);
+		uInt32 num_ai_chans = 0;
+		DAQmxGetTaskNumChans(AI_taskHandle_, &num_ai_chans);
+		num_chans_ = (int)num_ai_chans;
+		if ((num_chans_ < 1) || (num_chans_ > raw_max_chans)) { Error_Handler(-1, "AI Channel count"); }
+		status = DAQmxCfgSampClkTiming(AI_taskHandle_, "", input_rate_, DAQmx_Val_Rising, DAQmx_Val_ContSamps, samples_per_scan_);
+		if (status) { Error_Handler(status, "AI Task setup"); }
+
+		// If recording raw samples, get the device scaling (raw to volts) of each input channel
+		if (raw_recording_)
+		{
+			char channel_name[256];
+			for (int c = 0; c < num_chans_; c++)
+			{
+				status = DAQmxGetNthTaskChannel(AI_taskHandle_, c + 1, channel_name, sizeof(channel_name));
+				if (status) { Error_Handler(status, "AI Channel name"); }
+				status = DAQmxGetAIDevScalingCoeff(AI_taskHandle_, channel_name, scaling_coeffs_[c], 4);
+				if (status) { Error_Handler(status, "AI Scaling coefficients"); }
+			}
+		}
+
+		// Create analog output task
+		DAQmxCreateTask("", &AO_taskHandle_);
+		DAQmxCreateAOVoltageChan(AO_taskHandle_, (device_ + "/" + ao_channels_).c_str(), "", -10.0, 10.0, DAQmx_Val_Volts, NULL);
+		DAQmxCfgSampClkTiming(AO_taskHandle_, "", output_rate_, DAQmx_Val_Rising, DAQmx_Val_ContSamps, pixels_per_scan_);
+		status = DAQmxCfgDigEdgeStartTrig(AO_taskHandle_, ("/" + device_ + "/ai/StartTrigger").c_str(), DAQmx_Val_Rising);
+		if (status) { Error_Handler(status, "AO Task setup"); }
+
+		// Read samples from the device
+		source_ = new Daq_Source(AI_taskHandle_, num_chans_, scaling_coeffs_);
+	}
+
+	// Check channel count (every channel is binned, averaged and saved, the raw header keeps the scaling of raw_max_chans)
+	if ((num_chans_ < 1) || (num_chans_ > raw_max_chans)) { Error_Handler(-1, "Channel count"); }
+
+	// If keeping a pretrigger buffer, allocate it now (averaged frames covering the requested duration, within the memory limit)
+	if (pretrigger_duration_ > 0.0)
+	{
+		double frame_period = ((double)samples_per_scan_ / input_rate_) * frames_to_average_;
+		double frame_bytes = (double)num_chans_ * pixels_per_frame_ * sizeof(float);
+		int capacity = (int)ceil(pretrigger_duration_ / frame_period);
+		capacity = (int)std::min((double)capacity, pretrigger_max_bytes / frame_bytes);
+		pretrigger_ = new Pretrigger_Buffer(pretrigger_path_, x_pixels_, y_pixels_, num_chans_, capacity, writer_options_);
+
+		// Watch the trigger line (if any, and acquiring from the device)
+		if (!pretrigger_line_.empty() && (AI_taskHandle_ != 0))
+		{
+			DAQmxCreateTask("", &DI_taskHandle_);
+			DAQmxCreateDIChan(DI_taskHandle_, pretrigger_line_.c_str(), "", DAQmx_Val_ChanPerLine);
+			status = DAQmxStartTask(DI_taskHandle_);
+			if (status) { Error_Handler(status, "DI Task setup"); }
+		}
+	}
+
+	// Carve the acquisition buffers from one aligned arena (allocated and touched now, nothing is allocated while scanning)
+	buffer_size_ = (int)(input_rate_ * num_chans_); // Make buffer large enough to hold 1000 ms of data (all channels)
+	size_t binned_floats = (size_t)pixels_per_frame_ * num_chans_;
+	size_t arena_bytes = Arena::Footprint(sizeof(double) * buffer_size_) + Arena::Footprint(sizeof(float) * binned_floats);
+	if (raw_recording_)
+	{
+		arena_bytes += Arena::Footprint(sizeof(short) * buffer_size_);
+	}
+	arena_ = new Arena(arena_bytes);
+	input_buffer_ = (double*) arena_->Allocate(sizeof(double) * buffer_size_);
+	binned_frames_ = (float*) arena_->Allocate(sizeof(float) * binned_floats);
+	raw_buffer_ = raw_recording_ ? (short*) arena_->Allocate(sizeof(short) * buffer_size_) : NULL;
+	if ((input_buffer_ == NULL) || (binned_frames_ == NULL) || (raw_recording_ && (raw_buffer_ == NULL))) { Error_Handler(-1, "Acquisition buffers"); }
+
+	// If binning on several threads, start the workers (at the scanner thread's priority, on any CPU)
+	tuning_failures_ = 0;
+	if (binning_threads_ != 1)
+	{
+		binning_pool_ = new Worker_Pool(binning_threads_);
+		Thread_Options worker_options;
+		worker_options.priority = thread_options_[THREAD_SCANNER].priority;
+		if (!Thread_Tuning::Is_Default(worker_options) && !binning_pool_->Set_Thread_Options(worker_options))
+		{
+			tuning_failures_++;
+		}
+	}
+
+	// If requested, lock the acquisition buffers in physical memory (scanning never waits on paging)
+	if (lock_memory_ && !arena_->Lock())
+	{
+		tuning_failures_++;
+	}
+
+	// Keep the latest averaged frames for callers and subscribers (a referenced buffer is not reused until released, the writer can hold a full queue)
+	int pool_buffers = frame_pool_buffers_;
+	if ((images_to_save_ > 0) || streaming_)
+	{
+		pool_buffers += writer_options_.queue_length;
+	}
+	frame_pool_ = new Frame_Pool(x_pixels_, y_pixels_, num_chans_, pool_buffers);
+	if (!frame_pool_->Allocated()) { Error_Handler(-1, "Frame pool buffers"); }
+	frame_bus_ = new Frame_Bus(frame_pool_);
+
+	// If publishing frames to other processes, create the shared memory ring (fed from the frame bus)
+	if (!frame_ring_name_.empty())
+	{
+		frame_ring_ = new Frame_Ring(frame_ring_name_, frame_ring_slots_, x_pixels_, y_pixels_, num_chans_);
+		if (!frame_ring_->Is_Open()) { Error_Handler(-1, "Frame ring open"); }
+		Frame_Ring* frame_ring = frame_ring_;
+		frame_bus_->Subscribe([frame_ring](const Frame_Ref& frame) { frame_ring->Publish(frame.data, frame.timestamp); });
+	}
+
+	// If publishing telemetry, create the shared memory block
+	initialize_time_ = std::chrono::steady_clock::now();
+	memset(&counters_, 0, sizeof(counters_));
+	if (!telemetry_name_.empty())
+	{
+		telemetry_ = new Telemetry(telemetry_name_, true);
+	}
+
+	// If tracing, start the trace recorder (threads register their own event buffers)
+	if (!trace_path_.empty())
+	{
+		trace_ = new Trace_Recorder(trace_path_, trace_events_);
+	}
 
 	// Start the scan acquisition thread
 	active_ = true;
@@ -73,47 +249,116 @@ void Scanner::Initialize(
 // Scanner thread function
 void Scanner::Scanner_Thread_Function()
 {
+	// Set the priority and CPU of this thread (if configured)
+	if (!Thread_Tuning::Is_Default(thread_options_[THREAD_SCANNER]) && !Thread_Tuning::Apply_Current(thread_options_[THREAD_SCANNER]))
+	{
+		tuning_failures_++;
+	}
+
 	// Open a GLFW (OpenGL) display window (on a seperate thread) with frame sized texture buffer
 	Display display(x_pixels_, y_pixels_);
+	display.Set_Latency_Histograms(&stage_latency_[STAGE_UPLOAD], &stage_latency_[STAGE_RENDER]);
+	if (!Thread_Tuning::Is_Default(thread_options_[THREAD_DISPLAY]) && !display.Set_Thread_Options(thread_options_[THREAD_DISPLAY]))
+	{
+		tuning_failures_++;
+	}
+
+	// If tracing, get event buffers for this thread and the display thread
+	Trace_Buffer* trace = NULL;
+	if (trace_ != NULL)
+	{
+		trace = trace_->Register_Thread("Scanner");
+		display.Set_Trace(trace_->Register_Thread("Display"));
+	}
 
 	// Set display window size and position
 	// TO DO!!!
 
-	// Load the default image, resize, and load into memory shared with the display thread
-	int default_image_width;
-	int default_image_height;
+	// Map the default image (viewed in place if stored as uncompressed float32, otherwise converted or read with libtiff)
+	int default_image_width = 0;
+	int default_image_height = 0;
 	char* default_image_path = "C:\\Repos\\Dreosti-Lab\\Dreo2P\\Dreo2P_Project\\Dreo2P_Console\\bin\\x64\\Debug\\Dreo2P.tif";
-	std::vector<float> default_image_data = Load_32f_1ch_Tiff_Frame_From_File(default_image_path, &default_image_width, &default_image_height);
-	std::vector<float> default_frame_data(pixels_per_frame_);
-	
-	// Fill default frame with data from default image
+	Stack_Reader default_image(default_image_path);
+	Frame_View default_view = default_image.Frame(0);
+	std::vector<float> default_image_data;
+	const float* default_pixels = NULL;
+	if ((default_view.data != NULL) && (default_view.bytes_per_sample == 4) && (default_view.sample_format == SAMPLEFORMAT_IEEEFP))
+	{
+		default_pixels = (const float*)default_view.data;
+	}
+	else if (default_view.data != NULL)
+	{
+		default_image_data.resize(default_view.width * default_view.height);
+		default_image.Frame_To_Float(0, 0, default_image_data.data());
+		default_pixels = default_image_data.data();
+	}
+	else
+	{
+		default_image_data = Load_32f_1ch_Tiff_Frame_From_File(default_image_path, &default_image_width, &default_image_height);
+		default_pixels = default_image_data.data();
+	}
+	if (default_view.data != NULL)
+	{
+		default_image_width = default_view.width;
+		default_image_height = default_view.height;
+	}
+
+	// Fill display frame (shared with the display thread) with data from default image, repeated to fill the frame
+	int default_image_pixels = default_image_width * default_image_height;
 	for (int i = 0; i < pixels_per_frame_; i++)
 	{
-		default_frame_data[i] = default_image_data[i % (default_image_width*default_image_height)];
+		display.frame_data_A_[i] = (default_image_pixels > 0) ? default_pixels[i % default_image_pixels] : 0.0f;
 	}
-	
+	default_image.Close();
+
 	// Set display frame to default image
-	std::copy(default_frame_data.begin(), default_frame_data.end(), display.frame_data_A_.begin());
 	display.use_A_ = true;
 	display.min_ = 0.0f;
 	display.max_ = 1.0f;
 
-	// Allocate space for analog input data
-	int	buffer_size = (int)(input_rate_ * num_chans_); // Make buffer large enough to hold 1000 ms of 2 channel data
-	double*	input_buffer = (double*) malloc(sizeof(double) * buffer_size);
-	std::vector<float>	frame_ch0(pixels_per_frame_);
-	std::vector<float>	frame_ch1(pixels_per_frame_);
-	std::vector<float>	frame_display(pixels_per_frame_ * 4);
+	// Space for analog input data (from the arena)
+	int	buffer_size = buffer_size_;
+	double*	input_buffer = input_buffer_;
 
-	// If saving, prepare TIFF file for writing
-	TIFF *frame_0_tiff = NULL;
-	TIFF *frame_1_tiff = NULL;
-	if (images_to_save_ > 0)
+	// Create binner (bins scan lines into running average frames, kept in the arena)
+	Binner binner(x_pixels_, y_pixels_, pixels_per_line_, bin_factor_, frames_to_average_, 0, num_chans_, binned_frames_);
+
+	// If saving, start TIFF writer (on a seperate thread, so scanning continues while frames are written)
+	Writer* writer = NULL;
+	if ((images_to_save_ > 0) || streaming_)
 	{
-		std::string frame_0_path = file_path_ + std::string("_0.tiff");
-		std::string frame_1_path = file_path_ + std::string("_1.tiff");
-		frame_0_tiff = TIFFOpen(frame_0_path.c_str(), "w");
-		frame_1_tiff = TIFFOpen(frame_1_path.c_str(), "w");
+		writer = new Writer(file_path_, x_pixels_, y_pixels_, num_chans_, Projected_Pages(), Projected_Pages(), writer_options_);
+		writer->Set_Latency_Histogram(&stage_latency_[STAGE_WRITE]);
+		if (trace_ != NULL) { writer->Set_Trace(trace_->Register_Thread("Writer")); }
+		if (!Thread_Tuning::Is_Default(thread_options_[THREAD_WRITER]) && !writer->Set_Thread_Options(thread_options_[THREAD_WRITER]))
+		{
+			tuning_failures_++;
+		}
+	}
+
+	// If streaming, the writer subscribes to the frame bus (queues a reference to each published frame, no copy)
+	// (Publish calls subscribers on this thread, so stream_queued tells the scan loop whether the frame reached the writer queue)
+	int writer_subscription = -1;
+	bool stream_queued = false;
+	if ((writer != NULL) && streaming_)
+	{
+		writer_subscription = frame_bus_->Subscribe([this, writer, trace, &stream_queued](const Frame_Ref& frame)
+		{
+			unsigned long long queue_start = Tsc_Clock::Now();
+			stream_queued = writer->Write_Frame(frame_pool_, frame);
+			unsigned long long queue_end = Tsc_Clock::Now();
+			stage_latency_[STAGE_QUEUE].Record(queue_end - queue_start);
+			if (trace != NULL) { trace->Record("Queue", queue_start, queue_end); }
+		});
+	}
+
+	// If recording raw samples, start raw recorder (samples are then read as int16 and scaled to volts here)
+	Raw_Recorder* raw_recorder = NULL;
+	short* raw_buffer = NULL;
+	if (raw_recording_)
+	{
+		raw_recorder = new Raw_Recorder(raw_path_, Make_Raw_Header(), raw_duration_);
+		raw_buffer = raw_buffer_;
 	}
 
 	// Declare helper local variables
@@ -122,17 +367,17 @@ void Scanner::Scanner_Thread_Function()
 	int32 num_read_samples = 0;
 	int	num_new_samples = 0;
 	int num_full_scan_lines = 0;
-	int current_frame = 0;
-	int current_line = 0;
-	int	current_column = 0;
-	float ch0_accum = 0.0f;
-	float ch1_accum = 0.0f;
-	float ch0_value = 0.0f;
-	float ch1_value = 0.0f;
-	int sample_ch0 = 0;
-	int sample_ch1 = 0;
 	bool first_scan = true;
 	int	initial_offset = 0;
+	int saved_frames = 0;
+	long long binned_lines = 0;
+	long long group_frames = 0;
+	double elapsed = 0.0;
+	std::chrono::steady_clock::time_point scan_start;
+	unsigned long long stage_start = 0;
+	unsigned long long stage_end = 0;
+	unsigned long long pass_start = 0;
+	unsigned long long pacing_ticks = (unsigned long long)(Tsc_Clock::Ticks_Per_Microsecond() * 16000.0);	// Pacing sleep (16 ms)
 
 	// Initialize error status
 	int status = 0;
@@ -146,18 +391,20 @@ void Scanner::Scanner_Thread_Function()
 
 		// Wait for start signal
 		//std::cout << "Waiting for start...";
-		while (!scanning_ && active_)
 		{
-			Sleep(32);
+			std::unique_lock<std::mutex> lock(signal_mutex_);
+			start_signal_.wait(lock, [this] { return scanning_ || !active_; });
 		}
 		// Check if scanner completely closed
 		if (!active_) { break; }
 
 		// Scan acquisition loop
-		current_frame = 0;
-		current_line = 0;
-		current_column = 0;
+		binner.Reset();
 		num_residual_samples = 0;
+		saved_frames = 0;
+		binned_lines = 0;
+		group_frames = 0;
+		pixel_rate_ = 0.0;
 		first_scan = true;
 		while (scanning_)
 		{
@@ -167,21 +414,39 @@ void Scanner::Scanner_Thread_Function()
 				// Open shutter
 				Set_Shutter_State(true);
 
-				// Start hardware acqusition
-				status = DAQmxStartTask(AI_taskHandle_);
+				// Start hardware acqusition (or the next replayed segment)
+				status = source_->Start();
 				if (status) { Error_Handler(status, "AI Task start"); }
 				//std::cout << "Starting scanner.\n";
 
-				// Read available input samples (on all channels) and discard!
-				status = DAQmxReadAnalogF64(AI_taskHandle_, sample_shift_, 1.0, DAQmx_Val_GroupByScanNumber, &input_buffer[0], buffer_size, &num_read_samples, NULL);
+				// Read available input samples (on all channels) and discard! (but keep them in a raw recording, for re-binning with a different shift)
+				if (raw_recorder != NULL)
+				{
+					raw_recorder->Start_Segment();
+				}
+				num_read_samples = source_->Read(sample_shift_, &input_buffer[0], raw_buffer, buffer_size / num_chans_);
+				if ((raw_recorder != NULL) && (num_read_samples > 0))
+				{
+					raw_recorder->Record(raw_buffer, num_read_samples);
+				}
 
-				// Reset first scan indicator
+				// Reset first scan indicator (and start streaming clock)
 				first_scan = false;
+				scan_start = std::chrono::steady_clock::now();
 			}
 
-			// Read available input samples (on all channels)
-			status = DAQmxReadAnalogF64(AI_taskHandle_, -1, 1.0, DAQmx_Val_GroupByScanNumber, &input_buffer[num_residual_samples*num_chans_], buffer_size, &num_read_samples, NULL);
-			if (status) { Error_Handler(status, "AI Task read"); }
+			// Read available input samples (on all channels), recording raw samples (if any) before they are scaled to volts
+			stage_start = Tsc_Clock::Now();
+			num_read_samples = source_->Read(-1, &input_buffer[num_residual_samples*num_chans_], raw_buffer, (buffer_size / num_chans_) - num_residual_samples);
+			stage_end = Tsc_Clock::Now();
+			stage_latency_[STAGE_READ].Record(stage_end - stage_start);
+			if (trace != NULL) { trace->Record("Read", stage_start, stage_end); }
+			if (num_read_samples < 0) { Error_Handler(num_read_samples, "AI Task read"); }
+			counters_.scans_read += num_read_samples;
+			if (raw_recorder != NULL)
+			{
+				raw_recorder->Record(raw_buffer, num_read_samples);
+			}
 			
 			// How many new samples (including left-over from previous scan)?
 			num_new_samples = num_read_samples + num_residual_samples;
@@ -190,82 +455,88 @@ void Scanner::Scanner_Thread_Function()
 			num_full_scan_lines = (int)floor(num_new_samples / samples_per_line_);
 
 			// Extract samples for each channel from interleaved data array, bin, and sort into seperate frames (ignoring flyback)
-			for (int i = 0; i < num_full_scan_lines; i++)
+			pass_start = Tsc_Clock::Now();
+			for (int i = 0; i < num_full_scan_lines; )
 			{
-				// Check if we reach the end of a complete frame...
-				if (current_line == y_pixels_)
+				// Bin a block of lines (up to the end of the frame, split across the binning pool), recording the time per line
+				stage_start = Tsc_Clock::Now();
+				int block_lines = binner.Bin_Lines(&input_buffer[(size_t)i * samples_per_line_ * num_chans_], num_full_scan_lines - i, binning_pool_);
+				stage_latency_[(binner.Current_Frame() == 0) ? STAGE_BIN : STAGE_AVERAGE].Record((Tsc_Clock::Now() - stage_start) / block_lines);
+				i += block_lines;
+				binned_lines += block_lines;
+				if (binner.Frame_Complete())
 				{
-					// Report progress
-					//std::cout << "Frame: " << current_frame + 1 << " of " << frames_to_average_ << std::endl;
+					counters_.frames_completed++;
+					group_frames++;
+					Signal_Event(EVENT_FRAME);
+				}
 
-					// Reset scan_line pointer
-					current_line = 0;
-					current_column = 0;
+				// If saving images AND averaging frames, then stop after a full set of averages have been acquired
+				if (binner.Group_Complete())
+				{
+					// Report progress
+					//std::cout << "Averaged frame complete." << std::endl;
+					counters_.groups_completed++;
 
-					// Increment frame counter
-					current_frame++;
+					// Publish averaged frame to callers
+					double frame_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - initialize_time_).count();
+					stream_queued = false;
+					bool published = frame_bus_->Publish(binner.frames_, frame_time);
+					Signal_Event(EVENT_GROUP);
 
-					// If saving images AND averaging frames, then stop after a full set of averages have been acquired...otherwise just reset count
-					if (current_frame == frames_to_average_)
+					// Keep averaged frame in the pretrigger buffer
+					if (pretrigger_ != NULL)
 					{
-						current_frame = 0;
-						if (images_to_save_ > 0)
-						{
-							scanning_ = false;
-							break;	// Leave this scan group
-						}
+						pretrigger_->Push(binner.frames_);
 					}
-				}
 
-				// Loop though columns
-				current_column = 0;
-				for (int j = 0; j < (samples_per_line_*num_chans_); j += (num_chans_*bin_factor_))
-				{
-					// Bin subsequent samples into a pixel value
-					ch0_accum = 0.0f;
-					ch1_accum = 0.0f;
-					for (int b = 0; b < bin_factor_*num_chans_; b+=num_chans_)
+					if (streaming_)
 					{
-						sample_ch0 = ((i*samples_per_line_*num_chans_) + j) + b;
-						sample_ch1 = ((i*samples_per_line_*num_chans_) + j) + b + 1;
+						// Append averaged frame to stack (queued by the writer's subscription, copied only if every pool buffer was held) and keep scanning (until frame count or duration is reached)
+						if (!published)
+						{
+							stream_queued = writer->Write_Frames(binner.frames_);
+						}
 
-						// read input and split channels
-						ch0_accum += (float)input_buffer[sample_ch0];
-						ch1_accum += (float)input_buffer[sample_ch1];
-					}
-					// Save average pixel value in image frames
-					if (current_column < x_pixels_)
-					{
-						// Store running average pixel value for display/saving
-						if (current_frame > 0)
+						// Count only queued frames (a full writer queue drops the frame, reported as frames_dropped in the telemetry)
+						if (stream_queued)
+						{
+							saved_frames++;
+						}
+						else
 						{
-							// Store current pixel value
-							ch0_value = frame_ch0[(current_line * x_pixels_) + current_column];
-							ch1_value = frame_ch1[(current_line * x_pixels_) + current_column];
-							
-							// Weight by number of averages thus far
-							ch0_value = ch0_value * (float) (current_frame);
-							ch1_value = ch1_value * (float) (current_frame);
-
-							// Add new measurement
-							ch0_value += (ch0_accum / (float)bin_factor_);
-							ch1_value += (ch1_accum / (float)bin_factor_);
-
-							// Divide by number of frames acquired
-							frame_ch0[(current_line * x_pixels_) + current_column] = ch0_value / (float)(current_frame + 1);
-							frame_ch1[(current_line * x_pixels_) + current_column] = ch1_value / (float)(current_frame + 1);
+							counters_.frames_dropped = writer->Frames_Dropped();
 						}
-						else {
-							frame_ch0[(current_line * x_pixels_) + current_column] = ch0_accum / (float)bin_factor_;
-							frame_ch1[(current_line * x_pixels_) + current_column] = ch1_accum / (float)bin_factor_;
+						elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - scan_start).count();
+						if (((images_to_save_ > 0) && (saved_frames >= images_to_save_)) || ((duration_ > 0.0) && (elapsed >= duration_)))
+						{
+							scanning_ = false;
+							break;	// Leave this scan group
 						}
 					}
-					// Increment column counter
-					current_column++;
+					else if (images_to_save_ > 0)
+					{
+						scanning_ = false;
+						break;	// Leave this scan group
+					}
 				}
-				
-				// Increment scan line indicator
-				current_line++;
+			}
+
+			if ((trace != NULL) && (num_full_scan_lines > 0)) { trace->Record("Bin", pass_start, Tsc_Clock::Now()); }
+
+			// Measure end-to-end throughput (binned pixels per second)
+			elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - scan_start).count();
+			if (elapsed > 0.0)
+			{
+				pixel_rate_ = (binned_lines * x_pixels_) / elapsed;
+				counters_.frame_rate = group_frames / elapsed;
+			}
+			Publish_Telemetry(writer, raw_recorder);
+
+			// End the scan group when a replayed segment runs out of samples
+			if (source_->Is_Finished())
+			{
+				scanning_ = false;
 			}
 
 			// Are we still scanning? If so, prepare for next input and update display
@@ -274,34 +545,26 @@ void Scanner::Scanner_Thread_Function()
 				// Append residual samples from previous read to input buffer
 				num_residual_samples = num_new_samples - (num_full_scan_lines * samples_per_line_);
 				residual_sample_offset = (num_full_scan_lines * samples_per_line_ * num_chans_);
-				for (int r = 0; r < num_residual_samples*num_chans_; r += num_chans_)
+				for (int r = 0; r < num_residual_samples*num_chans_; r++)
 				{
 					input_buffer[r] = input_buffer[residual_sample_offset + r];
-					input_buffer[r + 1] = input_buffer[residual_sample_offset + r + 1];
 				}
 
-				// Update display frames (use double buffering!)
+				// Update display frames (use double buffering!) with the selected channel (channel 0 if out of range)
+				stage_start = Tsc_Clock::Now();
+				const float* display_frame = binner.Channel(((display_channel_ >= 0) && (display_channel_ < num_chans_)) ? display_channel_ : 0);
 				if (display.use_A_)
 				{
-					if (display_channel_ == 1)
-					{
-						std::copy(frame_ch1.begin(), frame_ch1.end(), display.frame_data_B_.begin());
-					}
-					else {
-						std::copy(frame_ch0.begin(), frame_ch0.end(), display.frame_data_B_.begin());
-					}
+					std::copy(display_frame, display_frame + pixels_per_frame_, display.frame_data_B_.begin());
 					display.use_A_ = false;
 				}
 				else {
-					if (display_channel_ == 1)
-					{
-						std::copy(frame_ch1.begin(), frame_ch1.end(), display.frame_data_A_.begin());
-					}
-					else {
-						std::copy(frame_ch0.begin(), frame_ch0.end(), display.frame_data_A_.begin());
-					}
+					std::copy(display_frame, display_frame + pixels_per_frame_, display.frame_data_A_.begin());
 					display.use_A_ = true;
 				}
+				stage_end = Tsc_Clock::Now();
+				stage_latency_[STAGE_DISPLAY_COPY].Record(stage_end - stage_start);
+				if (trace != NULL) { trace->Record("Publish", stage_start, stage_end); }
 
 				// Set display range
 				display.min_ = min_;
@@ -316,15 +579,30 @@ void Scanner::Scanner_Thread_Function()
 				}
 				if (scan_line_)
 				{
-					display.horz_line_ = (float)current_line/y_pixels_;
+					display.horz_line_ = (float)binner.Current_Line()/y_pixels_;
 				}
 				else
 				{
 					display.horz_line_ = -1.0f;
 				}
 
-				// Sleep the thread for a bit (no need to update tooooooo quickly)
-				Sleep(16);
+				// Check for a pretrigger dump request on the trigger line
+				Poll_Trigger_Line();
+
+				// Measure display and writer thread load
+				display_cpu_ = display.Cpu_Seconds();
+				if (writer != NULL) { writer_cpu_ = writer->Cpu_Seconds(); }
+
+				// Sleep the thread for a bit (no need to update tooooooo quickly), unless replaying as fast as possible
+				if (source_->Is_Paced())
+				{
+					// Measure how late the thread wakes (scheduling jitter)
+					stage_start = Tsc_Clock::Now();
+					Sleep(16);
+					stage_end = Tsc_Clock::Now();
+					stage_latency_[STAGE_WAKE].Record((stage_end - stage_start > pacing_ticks) ? (stage_end - stage_start - pacing_ticks) : 0);
+					if (trace != NULL) { trace->Record("Sleep", stage_start, stage_end); }
+				}
 			}
 		}
 
@@ -332,35 +610,51 @@ void Scanner::Scanner_Thread_Function()
 		Set_Shutter_State(false);
 
 		// Stop analog input/output tasks
-		DAQmxStopTask(AO_taskHandle_);
-		status = DAQmxStopTask(AI_taskHandle_);
+		if (AO_taskHandle_ != 0)
+		{
+			DAQmxStopTask(AO_taskHandle_);
+		}
+		status = source_->Stop();
 		if (status) { Error_Handler(status, "AI/AO Task stop"); }
+		Publish_Telemetry(writer, raw_recorder);
 		//std::cout << "Stopping scanner.\n";
 
-		// If saving, save (averaged) frame to TIFF stack
-		if ((images_to_save_ > 0) && active_)
+		// If saving (and not streaming), save (averaged) frame to TIFF stack
+		if ((images_to_save_ > 0) && !streaming_ && active_)
 		{
-			// Save frame 0
-			Scanner::Save_Frame_to_32f_1ch_Tiff(frame_0_tiff, frame_ch0, x_pixels_, y_pixels_, current_frame, images_to_save_);
-
-			// Save frame 1
-			Scanner::Save_Frame_to_32f_1ch_Tiff(frame_1_tiff, frame_ch1, x_pixels_, y_pixels_, current_frame, images_to_save_);
+			// Queue the averaged frame of every channel for the writer thread (it copies the saved channels)
+			stage_start = Tsc_Clock::Now();
+			writer->Write_Frames(binner.frames_);
+			stage_end = Tsc_Clock::Now();
+			stage_latency_[STAGE_QUEUE].Record(stage_end - stage_start);
+			if (trace != NULL) { trace->Record("Queue", stage_start, stage_end); }
 			
 			// Report saving
 			//std::cout << "Saving averaged frame.\n\n";
 		}
 
+		// Report the end of the scan group
+		Signal_Event(EVENT_STOPPED);
+
 		// Go back and wait for the next "start" signal
 	}
 
-	// Free input buffer
-	free(input_buffer);
+	// Close raw recording (after writing all queued samples)
+	if (raw_recorder != NULL)
+	{
+		raw_recorder->Close();
+		delete raw_recorder;
+	}
 
-	// Close TIFF files
-	if (images_to_save_ > 0)
+	// Close TIFF files (after writing all queued frames)
+	if (writer_subscription >= 0)
+	{
+		frame_bus_->Unsubscribe(writer_subscription);
+	}
+	if (writer != NULL)
 	{
-		TIFFClose(frame_0_tiff);
-		TIFFClose(frame_1_tiff);
+		writer->Close();
+		delete writer;
 	}
 
 	// Close GLFW window and thread
@@ -374,7 +668,10 @@ void Scanner::Scanner_Thread_Function()
 void Scanner::Start()
 {
 	// Start scanning loop (infinte or fixed number of frames)
+	std::lock_guard<std::mutex> lock(signal_mutex_);
 	scanning_ = true;
+	group_active_ = true;
+	start_signal_.notify_one();
 }
 
 
@@ -395,11 +692,77 @@ void Scanner::Close()
 	// End scanning thread (if active)
 	if (active_)
 	{
-		active_ = false;
-		scanning_ = false;
+		{
+			std::lock_guard<std::mutex> lock(signal_mutex_);
+			active_ = false;
+			scanning_ = false;
+			group_active_ = false;
+			start_signal_.notify_one();
+			event_signal_.notify_all();
+		}
 		scanner_thread_.join();
 	}
 
+	// Remove telemetry block
+	if (telemetry_ != NULL)
+	{
+		telemetry_->Close();
+		delete telemetry_;
+		telemetry_ = NULL;
+	}
+
+	// Remove frame ring (clients keep their mapping until they close it)
+	if (frame_ring_ != NULL)
+	{
+		frame_ring_->Close();
+		delete frame_ring_;
+		frame_ring_ = NULL;
+	}
+
+	// Stop binning workers
+	if (binning_pool_ != NULL)
+	{
+		binning_pool_->Close();
+		delete binning_pool_;
+		binning_pool_ = NULL;
+	}
+
+	// Free acquisition buffers
+	delete arena_;
+	arena_ = NULL;
+	input_buffer_ = NULL;
+	raw_buffer_ = NULL;
+	binned_frames_ = NULL;
+
+	// Free leased frames (callers must release their leases before closing)
+	delete frame_bus_;
+	frame_bus_ = NULL;
+	delete frame_pool_;
+	frame_pool_ = NULL;
+
+	// Save trace (all traced threads have stopped)
+	if (trace_ != NULL)
+	{
+		trace_->Save();
+		delete trace_;
+		trace_ = NULL;
+	}
+
+	// Stop pretrigger buffer (after writing requested dumps)
+	if (pretrigger_ != NULL)
+	{
+		pretrigger_->Close();
+		delete pretrigger_;
+		pretrigger_ = NULL;
+	}
+
+	// Delete sample source (unless provided by the caller)
+	if (source_ != external_source_)
+	{
+		delete source_;
+	}
+	source_ = NULL;
+
 	// Close NIDAQ tasks (if open)
 	if (DO_taskHandle_ != 0) {
 		DAQmxStopTask(DO_taskHandle_);
@@ -411,9 +774,14 @@ void Scanner::Close()
 	if (AI_taskHandle_ != 0) {
 		DAQmxClearTask(AI_taskHandle_);
 	}
+	if (DI_taskHandle_ != 0) {
+		DAQmxStopTask(DI_taskHandle_);
+		DAQmxClearTask(DI_taskHandle_);
+	}
 
 	// Free resources
-	free(scan_waveform_);
+	delete scan_pattern_;
+	scan_pattern_ = NULL;
 }
 
 
@@ -428,6 +796,16 @@ void Scanner::Configure_Display(int channel, float min, float max, bool centre_c
 }
 
 
+// Update device and channel names (must be set before Initialize, NULL = keep): e.g. "Dev2", "ai0:1", "ao0:1", "port0/line0" (empty shutter line = no shutter)
+void Scanner::Configure_Device(char *device, char *ai_channels, char *ao_channels, char *shutter_line)
+{
+	if (device != NULL) { device_ = std::string(device); }
+	if (ai_channels != NULL) { ai_channels_ = std::string(ai_channels); }
+	if (ao_channels != NULL) { ao_channels_ = std::string(ao_channels); }
+	if (shutter_line != NULL) { shutter_line_ = std::string(shutter_line); }
+}
+
+
 // Update display parameters
 void Scanner::Configure_Saving(char *path, int images_to_save)
 {
@@ -436,6 +814,308 @@ void Scanner::Configure_Saving(char *path, int images_to_save)
 }
 
 
+// Update streaming parameters (must be set before Initialize)
+void Scanner::Configure_Streaming(bool streaming, double duration)
+{
+	streaming_ = streaming;
+	duration_ = duration;
+}
+
+
+// Update TIFF file format and page layout (must be set before Initialize)
+void Scanner::Configure_File_Format(Tiff_Format format, Tiff_Layout layout)
+{
+	writer_options_.format = format;
+	writer_options_.layout = layout;
+}
+
+
+// Update TIFF compression and number of compression threads (must be set before Initialize)
+void Scanner::Configure_Compression(Tiff_Compression compression, int threads)
+{
+	writer_options_.compression = compression;
+	writer_options_.compression_threads = threads;
+}
+
+
+// Update on-disk sample format and uint16 calibration, volts = value * scale + offset (must be set before Initialize), returns false (and keeps the current format) if either is invalid
+bool Scanner::Configure_Sample_Format(Tiff_Sample_Format format, double offset, double scale)
+{
+	// Check format and calibration (a zero or non-finite scale cannot be inverted)
+	if ((format < TIFF_SAMPLE_FLOAT32) || (format > TIFF_SAMPLE_FLOAT16) || !std::isfinite(offset) || !std::isfinite(scale) || (scale == 0.0))
+	{
+		return false;
+	}
+	writer_options_.sample_format = format;
+	writer_options_.offset = offset;
+	writer_options_.scale = scale;
+	return true;
+}
+
+
+// Update saved channels and their layout on disk (must be set before Initialize)
+void Scanner::Configure_Channels(Tiff_Channel_Layout layout, int channel_mask)
+{
+	writer_options_.channel_layout = layout;
+	writer_options_.channel_mask = channel_mask;
+}
+
+
+// Update raw sample recording (must be set before Initialize), preallocates space for duration seconds
+void Scanner::Configure_Raw_Recording(char *path, double duration)
+{
+	raw_path_ = std::string(path);
+	raw_duration_ = duration;
+	raw_recording_ = true;
+}
+
+
+// Update pretrigger buffer: keep the last duration seconds of averaged frames (must be set before Initialize), dumped to path on request or on a rising edge of trigger_line (e.g. "Dev1/port0/line1", empty = none)
+void Scanner::Configure_Pretrigger(char *path, double duration, char *trigger_line)
+{
+	pretrigger_path_ = std::string(path);
+	pretrigger_duration_ = duration;
+	pretrigger_line_ = (trigger_line != NULL) ? std::string(trigger_line) : std::string();
+}
+
+
+// Dump the pretrigger buffer to disk (asynchronous, scanning continues)
+void Scanner::Dump_Pretrigger()
+{
+	if (pretrigger_ != NULL)
+	{
+		pretrigger_->Trigger();
+	}
+}
+
+
+// Replay a raw sample recording instead of acquiring (must be set before Initialize), paced at the recorded input rate or as fast as possible
+void Scanner::Configure_Replay(char *path, bool paced)
+{
+	replay_path_ = std::string(path);
+	replay_paced_ = paced;
+	replay_ = true;
+}
+
+
+// Scan a synthetic phantom instead of acquiring (must be set before Initialize): path is a ground truth stack (one plane per frame, cycling)
+void Scanner::Configure_Phantom(char *path, Phantom_Options options, bool paced)
+{
+	phantom_path_ = std::string(path);
+	phantom_options_ = options;
+	phantom_paced_ = paced;
+	phantom_ = true;
+}
+
+
+// Acquire from a caller provided sample source (must be set before Initialize, and outlive the scanner), e.g. a simulated device
+void Scanner::Configure_Source(Sample_Source* source)
+{
+	external_source_ = source;
+}
+
+
+// Binned pixels per second (per channel) in the current (or last) scan group
+double Scanner::Pixel_Rate()
+{
+	return pixel_rate_;
+}
+
+
+// CPU time used by the scanner and display threads (seconds, display time is updated while scanning)
+void Scanner::Thread_Cpu_Seconds(double* scanner, double* display)
+{
+	*scanner = Cpu_Meter::Thread_Seconds(scanner_thread_);
+	*display = display_cpu_;
+}
+
+
+// CPU time used by the binning worker threads (besides the scanner thread) and the writer threads (seconds, writer time is updated while scanning)
+void Scanner::Worker_Cpu_Seconds(double* binning, double* writer)
+{
+	*binning = (binning_pool_ != NULL) ? binning_pool_->Cpu_Seconds() : 0.0;
+	*writer = writer_cpu_;
+}
+
+
+// Latency summary of each pipeline stage (since Initialize or the last reset)
+Pipeline_Stats Scanner::Stats()
+{
+	Pipeline_Stats stats;
+	for (int s = 0; s < num_pipeline_stages; s++)
+	{
+		stats.stages[s] = stage_latency_[s].Stats();
+	}
+	return stats;
+}
+
+
+// Record a timeline of the scanner, display and writer threads (must be set before Initialize), saved as a Chrome trace (JSON) to path on Close
+void Scanner::Configure_Trace(char *path, int events_per_thread)
+{
+	trace_path_ = std::string(path);
+	trace_events_ = events_per_thread;
+}
+
+
+// Publish live counters to the named shared memory block (must be set before Initialize, empty = none)
+void Scanner::Configure_Telemetry(char *name)
+{
+	telemetry_name_ = (name != NULL) ? std::string(name) : std::string();
+}
+
+
+// Publish averaged frames to a named shared memory ring of num_slots frames, read by other processes (must be set before Initialize, empty = none)
+void Scanner::Configure_Frame_Ring(char *name, int num_slots)
+{
+	frame_ring_name_ = (name != NULL) ? std::string(name) : std::string();
+	frame_ring_slots_ = num_slots;
+}
+
+
+// Lease the latest averaged frame of a channel (in place, until released)
+bool Scanner::Acquire_Frame(int channel, Frame_Lease* lease)
+{
+	if (frame_pool_ == NULL)
+	{
+		lease->data = NULL;
+		lease->slot = -1;
+		return false;
+	}
+	return frame_pool_->Acquire(channel, lease);
+}
+
+
+// Release a frame lease
+void Scanner::Release_Frame(Frame_Lease* lease)
+{
+	if (frame_pool_ != NULL)
+	{
+		frame_pool_->Release(lease);
+	}
+}
+
+
+// Subscribe to averaged frames (called on the scanner thread for each published frame, returns -1 before Initialize)
+int Scanner::Subscribe_Frames(Frame_Subscriber subscriber)
+{
+	return (frame_bus_ != NULL) ? frame_bus_->Subscribe(subscriber) : -1;
+}
+
+
+// Unsubscribe from averaged frames
+void Scanner::Unsubscribe_Frames(int subscription)
+{
+	if (frame_bus_ != NULL)
+	{
+		frame_bus_->Unsubscribe(subscription);
+	}
+}
+
+
+// Sequence number of the latest averaged frame (-1 = none yet)
+long long Scanner::Frame_Sequence()
+{
+	return (frame_pool_ != NULL) ? frame_pool_->Latest_Sequence() : -1;
+}
+
+
+// Call back on each scan event (NULL = none), from the scanner thread
+void Scanner::Register_Callback(Scan_Callback callback, void* context)
+{
+	std::lock_guard<std::mutex> lock(signal_mutex_);
+	callback_ = callback;
+	callback_context_ = context;
+}
+
+
+// Block until the next frame or averaged frame is completed, or until the scan group has ended (returns at once if not scanning), timeout in seconds (< 0 = none)
+bool Scanner::Wait_For_Event(Scan_Event event, double timeout)
+{
+	std::unique_lock<std::mutex> lock(signal_mutex_);
+	long long start_count = event_counts_[event];
+	auto happened = [this, event, start_count]
+	{
+		if (event == EVENT_STOPPED) { return !group_active_; }
+		return (event_counts_[event] != start_count);
+	};
+	auto done = [this, &happened] { return happened() || !active_; };
+	if (timeout < 0.0)
+	{
+		event_signal_.wait(lock, done);
+	}
+	else
+	{
+		event_signal_.wait_for(lock, std::chrono::duration<double>(timeout), done);
+	}
+	return happened();
+}
+
+
+// Count a scan event, wake waiting callers and call back (scanner thread)
+void Scanner::Signal_Event(Scan_Event event)
+{
+	Scan_Callback callback;
+	void* context;
+	long long count;
+	{
+		std::lock_guard<std::mutex> lock(signal_mutex_);
+		count = ++event_counts_[event];
+		if ((event == EVENT_STOPPED) && !scanning_)
+		{
+			group_active_ = false;
+		}
+		callback = callback_;
+		context = callback_context_;
+		event_signal_.notify_all();
+	}
+	if (callback != NULL)
+	{
+		callback((int)event, count, context);
+	}
+}
+
+
+// Clear the stage latency histograms
+void Scanner::Reset_Stats()
+{
+	for (int s = 0; s < num_pipeline_stages; s++)
+	{
+		stage_latency_[s].Reset();
+	}
+}
+
+
+// Set the scheduling of a pipeline thread (must be set before Initialize): priority (0 = normal, 1 = high, 2 = real-time) and CPU (-1 = any)
+void Scanner::Configure_Thread(int thread, int priority, int cpu)
+{
+	if ((thread < 0) || (thread >= num_pipeline_threads)) { return; }
+	thread_options_[thread].priority = std::min(std::max(priority, (int)PRIORITY_NORMAL), (int)PRIORITY_REALTIME);
+	thread_options_[thread].cpu = cpu;
+}
+
+
+// Bin scan lines on num_threads threads (must be set before Initialize): 1 = the scanner thread only, 0 = one per core
+void Scanner::Configure_Binning_Threads(int num_threads)
+{
+	binning_threads_ = std::max(0, num_threads);
+}
+
+
+// Lock the acquisition buffers in physical memory (must be set before Initialize)
+void Scanner::Configure_Memory_Lock(bool lock)
+{
+	lock_memory_ = lock;
+}
+
+
+// Number of thread priority, affinity and memory lock requests refused (since Initialize)
+int Scanner::Tuning_Failures()
+{
+	return tuning_failures_;
+}
+
+
 // Check is scanner is running
 bool Scanner::Is_Scanning()
 {
@@ -450,6 +1130,9 @@ void Scanner::Reset_Mirrors()
 	double start_positions[4] = { scan_waveform_[0], scan_waveform_[0], scan_waveform_[1], scan_waveform_[1] };
 	int status = 0;
 
+	// No mirrors when replaying
+	if (AO_taskHandle_ == 0) { return; }
+
 	// Set mirrors to start position (2 updates to flush buffer)
 	status = DAQmxResetWriteOffset(AO_taskHandle_);
 	if (status) { Error_Handler(status, "AO Write offset"); }
@@ -471,90 +1154,147 @@ void Scanner::Reset_Mirrors()
 }
 
 
-// Generate the X and Y voltages for a raster scan pattern (unidirectional)
-void Scanner::Generate_Scan_Waveform()
+// Dump the pretrigger buffer on a rising edge of the trigger line
+void Scanner::Poll_Trigger_Line()
 {
-	// Check that input and out rates are multiples of one another
-	if ((input_rate_ > output_rate_) && ((int)input_rate_ % (int)output_rate_ != 0))
-	{
-		Error_Handler(-1, "Input and output rate ratio must be a positive integer.");
-	}
-	bin_factor_ = (int)input_rate_ / (int)output_rate_;
-
-	// Number of backwards (return) pixels
-	int backward_pixels = (int)floor(output_rate_ / 1000.0); // minimum 1 millisecond return
+	if (DI_taskHandle_ == 0) { return; }
 
-	// Compute forward scan velocity in volts/update (i.e. step size)
-	double forward_velocity = (2.0 * amplitude_) / x_pixels_;
+	// Read the line level (now)
+	uInt8 level = 0;
+	int32 num_read = 0;
+	int32 bytes_per_sample = 0;
+	int status = DAQmxReadDigitalLines(DI_taskHandle_, 1, 0.0, DAQmx_Val_GroupByChannel, &level, 1, &num_read, &bytes_per_sample, NULL);
+	if (status) { Error_Handler(status, "DI Task read"); }
 
-	// Compute overshoot pixels
-	int overshoot_pixels = floor( (12.5 *  ((2.0 * amplitude_) / 100.0)) / forward_velocity); // 12.5% amplitude overshoot
-	double overshoot_amplitude = amplitude_ + (forward_velocity * overshoot_pixels);
+	// Rising edge?
+	if ((num_read == 1) && (level != 0) && (trigger_level_ == 0))
+	{
+		pretrigger_->Trigger();
+	}
+	trigger_level_ = level;
+}
 
-	// Perform Hermite blend interpolation from end of line to start of next line
-	flyback_pixels_ = overshoot_pixels + backward_pixels + overshoot_pixels;
-	double *flyback = Scanner::Hermite_Blend_Interpolate(backward_pixels, overshoot_amplitude, -overshoot_amplitude, forward_velocity, forward_velocity);
 
-	// Compute the size of each scan segment: forward and flyback (turn, backward, turn)
-	pixels_per_line_ = x_pixels_ + flyback_pixels_;
-	pixels_per_scan_ = pixels_per_line_ * y_pixels_;
-	pixels_per_frame_ = x_pixels_ * y_pixels_;
-	samples_per_line_ = pixels_per_line_ * bin_factor_;
-	samples_per_scan_ = pixels_per_scan_ * bin_factor_;
+// Scan parameters needed to re-bin a raw recording
+Raw_Header Scanner::Make_Raw_Header()
+{
+	Raw_Header header;
+	memset(&header, 0, sizeof(header));
+	header.num_chans = num_chans_;
+	header.input_rate = input_rate_;
+	header.output_rate = output_rate_;
+	header.amplitude = amplitude_;
+	header.y_offset = y_offset_;
+	header.x_pixels = x_pixels_;
+	header.y_pixels = y_pixels_;
+	header.pixels_per_line = pixels_per_line_;
+	header.bin_factor = bin_factor_;
+	header.sample_shift = sample_shift_;
+	header.frames_to_average = frames_to_average_;
+	memcpy(header.scaling_coeffs, scaling_coeffs_, sizeof(scaling_coeffs_));
+	return header;
+}
 
-	// Create space for scan waveform (both X and Y values)
-	scan_waveform_ = (double *)malloc(sizeof(double) * pixels_per_scan_ * 2.0);
 
-	// Fill array with scan positions (voltages)
-	int offset = 0;
-	for (size_t j = 0; j < y_pixels_; j++)
+// Load the ground truth stack, create a phantom source that scans it, and save its ground truth next to the saved frames
+Phantom_Source* Scanner::Create_Phantom_Source()
+{
+	// Load ground truth planes (relative brightness, 1.0 = brightest pixel)
+	Stack_Reader reader(phantom_path_);
+	int num_planes = reader.Num_Frames();
+	Frame_View view = reader.Frame(0);
+	std::vector<float> volume((size_t)view.width * view.height * num_planes);
+	for (int p = 0; p < num_planes; p++)
 	{
-		// Go from -amp to +amp in +velocity steps
-		for (size_t i = 0; i < x_pixels_; i++)
-		{
-			// X value
-			scan_waveform_[offset] = (-1.0 * amplitude_) + (forward_velocity * i);
-			offset++;
-			// Y value
-			scan_waveform_[offset] = y_offset_ + (-1.0 * amplitude_) + (forward_velocity * j);	// This may not make sense! (assumes X = Y)
-			offset++;
-		}
-		// Then go from +amp to +overshoot_amp in +velocity steps
-		for (size_t i = 0; i < overshoot_pixels; i++)
+		if (!reader.Frame_To_Float(p, 0, &volume[(size_t)p * view.width * view.height]))
 		{
-			// X value
-			scan_waveform_[offset] = amplitude_ + (forward_velocity * i);
-			offset++;
-			// Y value
-			scan_waveform_[offset] = y_offset_ + (-1.0 * amplitude_) + (forward_velocity * j);	// This may not make sense! (assumes X = Y)
-			offset++;
+			Error_Handler(-1, "Phantom ground truth load");
 		}
-		// Then insert flyback from +overshoot_amp to -overshoot_amp
-		double current_velocity = forward_velocity;
-		double current_position = overshoot_amplitude;
-		for (size_t i = 0; i < backward_pixels; i++)
-		{
-			// X value
-			scan_waveform_[offset] = flyback[i];
-			offset++;
-			// Y value
-			scan_waveform_[offset] = y_offset_ + (-1.0 * amplitude_) + (forward_velocity * j);	// This may not make sense! (assumes X = Y)
-			offset++;
-		}
-		// Then go from -overshoot_amp to -amp in +velocity steps
-		for (size_t i = 0; i < overshoot_pixels; i++)
+	}
+	reader.Close();
+	float brightest = volume.empty() ? 0.0f : *std::max_element(volume.begin(), volume.end());
+	if (brightest > 0.0f)
+	{
+		for (size_t i = 0; i < volume.size(); i++) { volume[i] /= brightest; }
+	}
+
+	// Create phantom (scanned with the actual scan waveform), samples are scaled as recorded
+	Phantom_Source* phantom = new Phantom_Source(scan_waveform_, x_pixels_, y_pixels_, pixels_per_line_, bin_factor_, input_rate_, amplitude_, y_offset_, num_chans_, volume, view.width, view.height, phantom_options_, phantom_paced_);
+	phantom->Scaling_Coeffs(scaling_coeffs_);
+
+	// Save the expected (noise and lag free) frames of each plane
+	if (!file_path_.empty())
+	{
+		std::vector<float> truth_frames((size_t)pixels_per_frame_ * num_chans_);
+		Writer truth(file_path_ + "_ground_truth", x_pixels_, y_pixels_, num_chans_, phantom->Num_Planes(), phantom->Num_Planes(), writer_options_);
+		for (int p = 0; p < phantom->Num_Planes(); p++)
 		{
-			// X value
-			scan_waveform_[offset] = -overshoot_amplitude + (forward_velocity * i);
-			offset++;
-			// Y value
-			scan_waveform_[offset] = y_offset_ + (-1.0 * amplitude_) + (forward_velocity * j);	// This may not make sense! (assumes X = Y)
-			offset++;
+			for (int c = 0; c < num_chans_; c++)
+			{
+				phantom->Ground_Truth(p, c, &truth_frames[(size_t)c * pixels_per_frame_]);
+			}
+			truth.Write_Frames(truth_frames.data());
 		}
+		truth.Close();
+	}
+	return phantom;
+}
+
+
+// Update and publish the live counters (scanner thread)
+void Scanner::Publish_Telemetry(Writer* writer, Raw_Recorder* raw_recorder)
+{
+	if (telemetry_ == NULL) { return; }
+	counters_.scanning = scanning_ ? 1 : 0;
+	counters_.frame_width = x_pixels_;
+	counters_.frame_height = y_pixels_;
+	counters_.frames_to_average = frames_to_average_;
+	counters_.pixel_rate = pixel_rate_;
+	counters_.backlog_scans = source_->Backlog();
+	counters_.lines_dropped = source_->Scans_Dropped() / samples_per_line_;
+	counters_.raw_scans_dropped = (raw_recorder != NULL) ? raw_recorder->Scans_Dropped() : 0;
+	counters_.disk_queue_depth = (writer != NULL) ? writer->Queue_Depth() : 0;
+	counters_.frames_written = (writer != NULL) ? writer->Frames_Written() : 0;
+	counters_.frames_dropped = (writer != NULL) ? writer->Frames_Dropped() : 0;
+	counters_.write_errors = (writer != NULL) ? writer->Write_Errors() : 0;
+	counters_.timestamp = std::chrono::duration<double>(std::chrono::steady_clock::now() - initialize_time_).count();
+	telemetry_->Publish(counters_);
+}
+
+
+// Projected number of pages per TIFF stack (0 if the recording is unbounded)
+int Scanner::Projected_Pages()
+{
+	// Streaming appends to the same stack on every start (the frame and duration limits are per start), so the session is unbounded
+	if (streaming_)
+	{
+		return 0;
 	}
 
-	// Cleanup
-	free(flyback);
+	// A fixed number of saved frames
+	return std::max(0, images_to_save_);
+}
+
+
+// Generate the X and Y voltages for a raster scan pattern (unidirectional)
+void Scanner::Generate_Scan_Waveform()
+{
+	// Check that input and out rates are multiples of one another
+	if (!Scan_Pattern::Valid_Rates(input_rate_, output_rate_))
+	{
+		Error_Handler(-1, "Input and output rate ratio must be a positive integer.");
+	}
+
+	// Generate pattern and copy its geometry
+	scan_pattern_ = new Scan_Pattern(amplitude_, y_offset_, input_rate_, output_rate_, x_pixels_, y_pixels_);
+	scan_waveform_ = scan_pattern_->waveform_;
+	bin_factor_ = scan_pattern_->bin_factor_;
+	flyback_pixels_ = scan_pattern_->flyback_pixels_;
+	pixels_per_line_ = scan_pattern_->pixels_per_line_;
+	pixels_per_scan_ = scan_pattern_->pixels_per_scan_;
+	pixels_per_frame_ = scan_pattern_->pixels_per_frame_;
+	samples_per_line_ = scan_pattern_->samples_per_line_;
+	samples_per_scan_ = scan_pattern_->samples_per_scan_;
 
 	return;
 }
@@ -580,33 +1320,6 @@ void Scanner::Save_Scan_Waveform(std::string path, double* waveform)
 }
 
 
-// Helper Function: Blend interpolation
-double* Scanner::Hermite_Blend_Interpolate(int steps, double y1, double y2, double slope1, double slope2)
-{
-	double* curve = (double*)malloc(sizeof(double)*steps);
-	double next_y1 = y1;
-	double next_y2 = y2 + (-slope2 * steps);
-	for (size_t i = 0; i < steps; i++)
-	{
-		// Scale range from 0 to 1
-		double s = (double)i / double(steps);
-
-		// Compute Hermite basis functions
-		double h1 = (2.0 * s*s*s) - (3.0 * s*s) + 1.0;
-		double h2 = (-2.0 * s*s*s) + (3.0 * s*s);
-
-		// Compute interpolated point
-		double y = (h1 * next_y1) + (h2 * next_y2);
-		curve[i] = y;
-
-		// Increment
-		next_y1 += slope1;
-		next_y2 += slope2;
-	}
-	return curve;
-}
-
-
 // Control shutter state
 void Scanner::Set_Shutter_State(bool state)
 {
@@ -614,6 +1327,9 @@ void Scanner::Set_Shutter_State(bool state)
 	byte data[8] = { 0,0,0,0,0,0,0,0 };
 	data[0] = (state ? 1 : 0);
 
+	// No shutter when replaying
+	if (DO_taskHandle_ == 0) { return; }
+
 	// Write shutter state
 	int status = DAQmxWriteDigitalU8(DO_taskHandle_, 1, 1, 10.0, DAQmx_Val_GroupByChannel, data, NULL, NULL);
 	if (status) { Error_Handler(status, "DO Write"); }
@@ -662,30 +1378,6 @@ std::vector<float> Scanner::Load_32f_1ch_Tiff_Frame_From_File(char* path, int* w
 }
 
 
-// Save a float32 grayscale (single channel) data frame to a TIFF file
-void Scanner::Save_Frame_to_32f_1ch_Tiff(TIFF *tiff_file, std::vector<float> data, int width, int height, int current_page, int total_pages)
-{
-	// Set Tiff parameters (frame 0)
-	TIFFSetField(tiff_file, TIFFTAG_IMAGEWIDTH, x_pixels_);
-	TIFFSetField(tiff_file, TIFFTAG_IMAGELENGTH, y_pixels_);
-	TIFFSetField(tiff_file, TIFFTAG_ROWSPERSTRIP, y_pixels_);
-	TIFFSetField(tiff_file, TIFFTAG_BITSPERSAMPLE, 32);
-	TIFFSetField(tiff_file, TIFFTAG_SAMPLESPERPIXEL, 1);
-	TIFFSetField(tiff_file, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP);
-	TIFFSetField(tiff_file, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
-	TIFFSetField(tiff_file, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
-	TIFFSetField(tiff_file, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
-	TIFFSetField(tiff_file, TIFFTAG_FILLORDER, FILLORDER_MSB2LSB);
-	TIFFSetField(tiff_file, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-	TIFFSetField(tiff_file, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
-	TIFFSetField(tiff_file, TIFFTAG_PAGENUMBER, current_page, total_pages);
-
-	// Write frame data
-	TIFFWriteEncodedStrip(tiff_file, 0, data.data(), width*height*sizeof(float));
-	TIFFWriteDirectory(tiff_file);
-}
-
-
 // Scanner error callback function
 void Scanner::Error_Handler(int error, const char* description)
 {
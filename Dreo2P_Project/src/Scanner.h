@@ -8,6 +8,9 @@
 #include <thread>
 #include <atomic>
 #include <vector>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
 #include <math.h>
 
 // Inlcude Local Headers
@@ -15,6 +18,36 @@
 #include "tiffio.h"
 #include "NIDAQmx.h"
 #include "Display.h"
+#include "Writer.h"
+#include "Binner.h"
+#include "Raw_Recorder.h"
+#include "Pretrigger_Buffer.h"
+#include "Stack_Reader.h"
+#include "Daq_Source.h"
+#include "Replay_Source.h"
+#include "Phantom_Source.h"
+#include "Scan_Pattern.h"
+#include "Cpu_Meter.h"
+#include "Latency_Histogram.h"
+#include "Trace_Recorder.h"
+#include "Telemetry.h"
+#include "Frame_Pool.h"
+#include "Frame_Bus.h"
+#include "Arena.h"
+#include "Thread_Tuning.h"
+#include "Frame_Ring.h"
+
+// Scan events (reported to the callback, or waited for)
+enum Scan_Event
+{
+	EVENT_FRAME = 0,		// A frame was binned
+	EVENT_GROUP = 1,		// An averaged frame (scan group of frames_to_average) was completed
+	EVENT_STOPPED = 2		// The scan group ended (and its frame was queued for saving)
+};
+static const int	num_scan_events = 3;
+
+// Event callback (called on the scanner thread, must return quickly): event, number of such events so far, caller context
+typedef void (*Scan_Callback)(int event, long long count, void* context);
 
 class Scanner
 {
@@ -39,15 +72,59 @@ public:
 	void Close();
 	bool Is_Scanning();
 	void Configure_Display(int channel, float min, float max, bool centre_cross, bool scan_line);
+	void Configure_Device(char *device, char *ai_channels, char *ao_channels, char *shutter_line);
 	void Configure_Saving(char *path, int images_to_save);
+	void Configure_Streaming(bool streaming, double duration);
+	void Configure_File_Format(Tiff_Format format, Tiff_Layout layout);
+	void Configure_Compression(Tiff_Compression compression, int threads);
+	bool Configure_Sample_Format(Tiff_Sample_Format format, double offset, double scale);
+	void Configure_Channels(Tiff_Channel_Layout layout, int channel_mask);
+	void Configure_Raw_Recording(char *path, double duration);
+	void Configure_Pretrigger(char *path, double duration, char *trigger_line);
+	void Dump_Pretrigger();
+	void Configure_Replay(char *path, bool paced);
+	void Configure_Phantom(char *path, Phantom_Options options, bool paced);
+	void Configure_Source(Sample_Source* source);
+	double Pixel_Rate();
+	void Thread_Cpu_Seconds(double* scanner, double* display);
+	void Worker_Cpu_Seconds(double* binning, double* writer);
+	Pipeline_Stats Stats();
+	void Configure_Trace(char *path, int events_per_thread);
+	void Configure_Telemetry(char *name);
+	void Configure_Frame_Ring(char *name, int num_slots);
+	void Reset_Stats();
+	void Configure_Thread(int thread, int priority, int cpu);
+	void Configure_Memory_Lock(bool lock);
+	void Configure_Binning_Threads(int num_threads);
+	int Tuning_Failures();
+	bool Acquire_Frame(int channel, Frame_Lease* lease);
+	void Release_Frame(Frame_Lease* lease);
+	long long Frame_Sequence();
+	void Register_Callback(Scan_Callback callback, void* context);
+	bool Wait_For_Event(Scan_Event event, double timeout);
+	int Subscribe_Frames(Frame_Subscriber subscriber);
+	void Unsubscribe_Frames(int subscription);
 
 private:
 	// Private Members (NIDAQmx)
 	TaskHandle  DO_taskHandle_ = 0;
 	TaskHandle  AO_taskHandle_ = 0;
 	TaskHandle  AI_taskHandle_ = 0;
+	TaskHandle  DI_taskHandle_ = 0;
+
+	// Private Members (device and channels, relative to the device)
+	std::string	device_ = "Dev1";
+	std::string	ai_channels_ = "ai0:1";			// Two inputs (X and Y detectors)
+	std::string	ao_channels_ = "ao0:1";			// Two outputs (X and Y mirrors)
+	std::string	shutter_line_ = "port0/line0";	// Empty = no shutter
+
+	// Private Members (live instances in this process, each names its shared memory differently)
+	int					instance_;
+	static std::mutex			instances_mutex_;
+	static std::vector<bool>	instances_live_;	// Instance numbers in use (freed by the destructor)
 
 	// Private Members (scan parameters)
+	Scan_Pattern*	scan_pattern_ = NULL;
 	double*	scan_waveform_;
 	double	amplitude_;
 	double	y_offset_;
@@ -76,12 +153,91 @@ private:
 	// Private members (TIFF)
 	int					images_to_save_ = 0;
 	std::string			file_path_;
+	bool				streaming_ = false;	// Append every averaged frame while scanning continues
+	double				duration_ = 0.0;	// Maximum streaming duration in seconds (0 = no limit)
+	Writer_Options		writer_options_;
+
+	// Private members (raw sample recording)
+	bool				raw_recording_ = false;
+	std::string			raw_path_;
+	double				raw_duration_ = 0.0;
+	double				scaling_coeffs_[raw_max_chans][4];
+
+	// Private members (pretrigger buffer, dumped on request or on a rising edge of the trigger line)
+	std::string			pretrigger_path_;
+	double				pretrigger_duration_ = 0.0;
+	std::string			pretrigger_line_;
+	Pretrigger_Buffer*	pretrigger_ = NULL;
+	uInt8				trigger_level_ = 0;
+
+	// Private members (sample source, the DAQ device or a replayed raw recording)
+	Sample_Source*		source_ = NULL;
+	Sample_Source*		external_source_ = NULL;	// Provided by the caller (not deleted)
+	bool				replay_ = false;
+	bool				replay_paced_ = true;
+	std::string			replay_path_;
+	bool				phantom_ = false;
+	bool				phantom_paced_ = true;
+	std::string			phantom_path_;
+	Phantom_Options		phantom_options_;
+	std::atomic<double>	pixel_rate_ = 0.0;	// Binned pixels per second (per channel) in the current scan group
+	std::atomic<double>	display_cpu_ = 0.0;	// CPU time used by the display thread (seconds)
+	std::atomic<double>	writer_cpu_ = 0.0;	// CPU time used by the writer and compression threads (seconds, of the last writer)
+
+	// Private members (always-on stage latency histograms, recorded by the scanner, display and writer threads)
+	Latency_Histogram	stage_latency_[num_pipeline_stages];
+
+	// Private members (optional trace of the scanner, display and writer threads, saved on Close)
+	std::string			trace_path_;
+	int					trace_events_ = 0;
+	Trace_Recorder*		trace_ = NULL;
+
+	// Private members (live counters published to shared memory by the scanner thread)
+	std::string			telemetry_name_ = "Dreo2P_Telemetry";
+	Telemetry*			telemetry_ = NULL;
+	Telemetry_Counters	counters_;
+	std::chrono::steady_clock::time_point	initialize_time_;
+
+	// Private members (scheduling of the pipeline threads and locking of the acquisition buffers)
+	Thread_Options		thread_options_[num_pipeline_threads];
+	bool				lock_memory_ = false;
+	std::atomic<int>	tuning_failures_ = 0;	// Priority, affinity or memory lock requests refused
+
+	// Private members (scan lines binned in parallel blocks, by the scanner thread and the pool's workers)
+	int					binning_threads_ = 1;	// 1 = scanner thread only, 0 = one per core
+	Worker_Pool*		binning_pool_ = NULL;
+
+	// Private members (acquisition buffers of this scan configuration, carved from one arena at Initialize)
+	Arena*				arena_ = NULL;
+	int					buffer_size_ = 0;		// Input samples (all channels)
+	double*				input_buffer_ = NULL;
+	short*				raw_buffer_ = NULL;		// Raw recording only
+	float*				binned_frames_ = NULL;	// Running average frames (all channels)
+
+	// Private members (averaged frames leased in place by callers, published once and shared by every subscriber)
+	Frame_Pool*			frame_pool_ = NULL;
+	int					frame_pool_buffers_ = 8;
+	Frame_Bus*			frame_bus_ = NULL;
+
+	// Private members (averaged frames published to other processes)
+	std::string			frame_ring_name_;
+	int					frame_ring_slots_ = 0;
+	Frame_Ring*			frame_ring_ = NULL;
 
 	// Private Members (acquisition thread)
 	std::thread			scanner_thread_;
 	std::atomic<bool>	active_ = false;
 	std::atomic<bool>	scanning_ = false;
 
+	// Private Members (start signal, and events waited for by callers)
+	std::mutex			signal_mutex_;
+	std::condition_variable	start_signal_;
+	std::condition_variable	event_signal_;
+	long long			event_counts_[num_scan_events] = { 0, 0, 0 };
+	bool				group_active_ = false;		// From Start until the scan group has ended
+	Scan_Callback		callback_ = NULL;
+	void*				callback_context_ = NULL;
+
 	// Thread Function
 	void				Scanner_Thread_Function();
 
@@ -89,10 +245,14 @@ private:
 	void				Reset_Mirrors();
 	void				Generate_Scan_Waveform();
 	void				Set_Shutter_State(bool state);
+	void				Poll_Trigger_Line();
+	int					Projected_Pages();
+	Raw_Header			Make_Raw_Header();
+	Phantom_Source*		Create_Phantom_Source();
+	void				Publish_Telemetry(Writer* writer, Raw_Recorder* raw_recorder);
+	void				Signal_Event(Scan_Event event);
 	void				Save_Scan_Waveform(std::string path, double* waveform);
-	double*				Hermite_Blend_Interpolate(int steps, double y1, double y2, double slope1, double slope2);
 	std::vector<float> 	Load_32f_1ch_Tiff_Frame_From_File(char* path, int* width, int* height);
-	void				Save_Frame_to_32f_1ch_Tiff(TIFF *tiff_file, std::vector<float> data, int width, int height, int current_page, int total_pages);
 	void				Error_Handler(int error, const char* description);	// Scanner error handler function
 };
 
@@ -0,0 +1,105 @@
+// Dreo2P Shared Memory Class (source)
+#include "Shared_Memory.h"
+
+// Constructor
+Shared_Memory::Shared_Memory(std::string name, size_t bytes, bool create)
+{
+	name_ = name;
+	create_ = create;
+#ifdef _WIN32
+	// Create (or open) a page file backed mapping in this session's namespace
+	std::string mapping_name = "Local\\" + name;
+	if (create)
+	{
+		mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)bytes >> 32), (DWORD)(bytes & 0xFFFFFFFF), mapping_name.c_str());
+	}
+	else
+	{
+		mapping_ = OpenFileMappingA(FILE_MAP_READ, FALSE, mapping_name.c_str());
+	}
+	if (mapping_ == NULL) { return; }
+	data_ = MapViewOfFile(mapping_, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, bytes);
+	if (data_ == NULL) { return; }
+
+	// Size of the view (whole pages, if opened without a size)
+	size_ = bytes;
+	if (bytes == 0)
+	{
+		MEMORY_BASIC_INFORMATION info;
+		VirtualQuery(data_, &info, sizeof(info));
+		size_ = info.RegionSize;
+	}
+#else
+	// Create (or open) a POSIX shared memory object
+	std::string object_name = "/" + name;
+	int file = create ? shm_open(object_name.c_str(), O_CREAT | O_RDWR, 0666) : shm_open(object_name.c_str(), O_RDONLY, 0);
+	if (file < 0) { return; }
+	if (create && (ftruncate(file, (off_t)bytes) != 0))
+	{
+		close(file);
+		return;
+	}
+
+	// Size of the object (if opened without a size)
+	size_ = bytes;
+	if (bytes == 0)
+	{
+		struct stat info;
+		fstat(file, &info);
+		size_ = (size_t)info.st_size;
+	}
+	void* data = mmap(NULL, size_, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	data_ = (data == MAP_FAILED) ? NULL : data;
+#endif
+	if (data_ == NULL) { size_ = 0; }
+}
+
+
+// Destructor
+Shared_Memory::~Shared_Memory()
+{
+	Close();
+}
+
+
+// Is the segment mapped?
+bool Shared_Memory::Is_Open()
+{
+	return (data_ != NULL);
+}
+
+
+// Start of the segment
+void* Shared_Memory::Data()
+{
+	return data_;
+}
+
+
+// Mapped size (bytes)
+size_t Shared_Memory::Size()
+{
+	return size_;
+}
+
+
+// Unmap (the publisher also removes the name, clients keep their mappings)
+void Shared_Memory::Close()
+{
+#ifdef _WIN32
+	if (data_ != NULL) { UnmapViewOfFile(data_); }
+	if (mapping_ != NULL) { CloseHandle(mapping_); }
+	mapping_ = NULL;
+#else
+	if (data_ != NULL)
+	{
+		munmap(data_, size_);
+		if (create_) { shm_unlink(("/" + name_).c_str()); }
+	}
+#endif
+	data_ = NULL;
+	size_ = 0;
+}
+
+// FIN
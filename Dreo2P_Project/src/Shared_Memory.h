@@ -0,0 +1,41 @@
+// Dreo2P Shared Memory Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+
+// Include platform headers (named file mappings on Windows, POSIX shared memory on Linux)
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// A named shared memory segment, created (read/write) by a publisher and opened (read only) by clients
+class Shared_Memory
+{
+public:
+	// Constructors
+	Shared_Memory(std::string name, size_t bytes, bool create);		// Clients may open with bytes = 0 (the whole segment)
+
+	// Destructors
+	~Shared_Memory();
+
+	// Public Methods
+	bool	Is_Open();
+	void*	Data();
+	size_t	Size();
+	void	Close();
+
+private:
+	// Private Members
+	std::string		name_;
+	bool			create_;
+	void*			data_ = NULL;
+	size_t			size_ = 0;
+#ifdef _WIN32
+	HANDLE			mapping_ = NULL;
+#endif
+};
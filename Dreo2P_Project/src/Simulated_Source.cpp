@@ -0,0 +1,169 @@
+// Dreo2P Simulated Source Class (source)
+#include "Simulated_Source.h"
+
+// Constructor
+Simulated_Source::Simulated_Source(double input_rate, int num_chans, double buffer_seconds)
+{
+	input_rate_ = input_rate;
+	num_chans_ = std::min(num_chans, raw_max_chans);
+	capacity_ = std::max(1LL, (long long)(buffer_seconds * input_rate));
+
+	// Fill a repeating pattern (a slow sine on each channel, with some "noise")
+	pattern_scans_ = 65536;
+	pattern_.resize((size_t)pattern_scans_ * num_chans_);
+	for (int s = 0; s < pattern_scans_; s++)
+	{
+		for (int c = 0; c < num_chans_; c++)
+		{
+			double phase = (6.283185307179586 * s * (c + 1)) / pattern_scans_;
+			pattern_[((size_t)s * num_chans_) + c] = (short)((3000.0 * sin(phase)) + ((s * 7919 + c * 104729) % 61) - 30);
+		}
+	}
+
+	// Scale as a +/-10 V, 16-bit ADC
+	for (int c = 0; c < raw_max_chans; c++)
+	{
+		scaling_coeffs_[c][0] = 0.0;
+		scaling_coeffs_[c][1] = 20.0 / 65536.0;
+		scaling_coeffs_[c][2] = 0.0;
+		scaling_coeffs_[c][3] = 0.0;
+	}
+}
+
+
+// Destructor
+Simulated_Source::~Simulated_Source()
+{
+}
+
+
+// Start acquiring (into an empty FIFO)
+int Simulated_Source::Start()
+{
+	read_position_ = 0;
+	start_time_ = std::chrono::steady_clock::now();
+	return 0;
+}
+
+
+// Read num_scans (-1 = all in the FIFO, up to max_scans), skipping scans that overflowed the FIFO
+int Simulated_Source::Read(int num_scans, double* volts, short* raw, int max_scans)
+{
+	// Wait for a fixed number of scans
+	if (num_scans >= 0)
+	{
+		while ((Scans_Acquired() - read_position_) < num_scans)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	// Measure backlog (and drop what the FIFO could not hold)
+	long long backlog = Scans_Acquired() - read_position_;
+	if (backlog > capacity_)
+	{
+		scans_dropped_ += backlog - capacity_;
+		read_position_ += backlog - capacity_;
+		backlog = capacity_;
+	}
+	if (backlog > peak_backlog_)
+	{
+		peak_backlog_ = backlog;
+	}
+
+	// Copy scans out of the FIFO (the repeating pattern)
+	int count = (int)std::min(backlog, (long long)max_scans);
+	if (num_scans >= 0)
+	{
+		count = std::min(count, num_scans);
+	}
+	int done = 0;
+	while (done < count)
+	{
+		int first = (int)((read_position_ + done) % pattern_scans_);
+		int length = std::min(count - done, pattern_scans_ - first);
+		const short* samples = &pattern_[(size_t)first * num_chans_];
+		if (raw != NULL)
+		{
+			std::copy(samples, samples + ((size_t)length * num_chans_), &raw[(size_t)done * num_chans_]);
+		}
+		Raw_Recorder::Scale_Samples(samples, &volts[(size_t)done * num_chans_], length, num_chans_, scaling_coeffs_);
+		done += length;
+	}
+	read_position_ += count;
+	scans_read_ += count;
+	return count;
+}
+
+
+// Stop acquiring
+int Simulated_Source::Stop()
+{
+	return 0;
+}
+
+
+// Samples arrive in real time
+bool Simulated_Source::Is_Paced()
+{
+	return true;
+}
+
+
+// The device never runs out of samples
+bool Simulated_Source::Is_Finished()
+{
+	return false;
+}
+
+
+// Scans read since construction
+long long Simulated_Source::Scans_Read()
+{
+	return scans_read_;
+}
+
+
+// Scans waiting in the FIFO
+long long Simulated_Source::Backlog()
+{
+	return std::min(Scans_Acquired() - read_position_, capacity_);
+}
+
+
+// Scans lost to FIFO overflow since construction
+long long Simulated_Source::Scans_Dropped()
+{
+	return scans_dropped_;
+}
+
+
+// Samples per scan
+int Simulated_Source::Num_Chans()
+{
+	return num_chans_;
+}
+
+
+// Largest FIFO level seen by a read (scans)
+long long Simulated_Source::Peak_Backlog()
+{
+	return peak_backlog_;
+}
+
+
+// Restart the peak backlog measurement
+void Simulated_Source::Reset_Peak_Backlog()
+{
+	peak_backlog_ = 0;
+}
+
+
+// Scans acquired by the device since Start
+long long Simulated_Source::Scans_Acquired()
+{
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+	return (long long)(elapsed * input_rate_);
+}
+
+// FIN
@@ -0,0 +1,56 @@
+// Dreo2P Simulated Source Class (header)
+#pragma once
+// Include STD headers
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <math.h>
+
+// Inlcude Local Headers
+#include "Sample_Source.h"
+#include "Raw_Recorder.h"
+
+// A device that acquires at input_rate into a bounded FIFO (samples are lost when the reader falls behind), at no CPU cost
+class Simulated_Source : public Sample_Source
+{
+public:
+	// Constructors
+	Simulated_Source(double input_rate, int num_chans, double buffer_seconds);
+
+	// Destructors
+	~Simulated_Source();
+
+	// Public Methods
+	int			Start();
+	int			Read(int num_scans, double* volts, short* raw, int max_scans);
+	int			Stop();
+	bool		Is_Paced();
+	bool		Is_Finished();
+	long long	Scans_Read();
+	long long	Backlog();				// Scans in the FIFO (up to its capacity)
+	long long	Scans_Dropped();		// Overwritten in the FIFO before they were read
+	int			Num_Chans();
+	long long	Peak_Backlog();			// Largest FIFO level seen by a read (since the last reset)
+	void		Reset_Peak_Backlog();
+
+private:
+	// Private Members (device)
+	double				input_rate_;
+	int					num_chans_;
+	long long			capacity_;			// FIFO size (scans)
+	std::vector<short>	pattern_;			// Repeating sample pattern (int16)
+	int					pattern_scans_;
+	double				scaling_coeffs_[raw_max_chans][4];
+
+	// Private Members (FIFO state, read by other threads)
+	std::chrono::steady_clock::time_point	start_time_;
+	long long				read_position_ = 0;
+	std::atomic<long long>	scans_read_ = 0;
+	std::atomic<long long>	scans_dropped_ = 0;
+	std::atomic<long long>	peak_backlog_ = 0;
+
+	// Private Methods
+	long long	Scans_Acquired();
+};
@@ -0,0 +1,433 @@
+// Dreo2P Stack Reader Class (source)
+#include "Stack_Reader.h"
+#include <fstream>
+#include <cstdlib>
+
+// Include platform headers
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Cached index file header
+struct Stack_Index_Header
+{
+	char		magic[8];			// "D2P_IX2"
+	long long	file_size;			// Stack size, modification time and first page when indexed (a stack changed since is indexed again)
+	long long	write_time;
+	long long	first_ifd;
+	long long	num_pages;
+};
+
+// Constructor
+Stack_Reader::Stack_Reader(std::string path)
+{
+	path_ = path;
+
+	// Map the whole file (read only)
+#ifdef _WIN32
+	file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (file_ == INVALID_HANDLE_VALUE) { return; }
+	LARGE_INTEGER size;
+	GetFileSizeEx(file_, &size);
+	size_ = size.QuadPart;
+	FILETIME write_time;
+	if (GetFileTime(file_, NULL, NULL, &write_time)) { write_time_ = ((long long)write_time.dwHighDateTime << 32) | write_time.dwLowDateTime; }
+	mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping_ == NULL) { Close(); return; }
+	data_ = (const unsigned char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	if (data_ == NULL) { Close(); return; }
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) { return; }
+	struct stat info;
+	fstat(file, &info);
+	size_ = info.st_size;
+	write_time_ = ((long long)info.st_mtim.tv_sec * 1000000000LL) + info.st_mtim.tv_nsec;
+	void* data = (size_ > 0) ? mmap(NULL, size_, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+	close(file);
+	if (data == MAP_FAILED) { size_ = 0; return; }
+	data_ = (const unsigned char*)data;
+#endif
+
+	// Check header (little endian classic TIFF or BigTIFF, as written by the Writer)
+	if ((size_ < 16) || (data_[0] != 'I') || (data_[1] != 'I'))
+	{
+		Close();
+		return;
+	}
+	int version = (int)Read_Unsigned(2, 2);
+	if (version == 42)
+	{
+		first_ifd_ = Read_Unsigned(4, 4);
+	}
+	else if (version == 43)
+	{
+		big_tiff_ = true;
+		first_ifd_ = Read_Unsigned(8, 8);
+	}
+	else
+	{
+		Close();
+		return;
+	}
+
+	// Use the cached index (if it is still valid), otherwise index pages as they are requested
+	if (!Load_Index())
+	{
+		next_ifd_ = first_ifd_;
+	}
+}
+
+
+// Destructor
+Stack_Reader::~Stack_Reader()
+{
+	Close();
+}
+
+
+// Is a stack mapped?
+bool Stack_Reader::Is_Open()
+{
+	return (data_ != NULL);
+}
+
+
+// Number of pages (indexes every page on first call, unless cached)
+int Stack_Reader::Num_Frames()
+{
+	while (Index_Next_Page()) {}
+	return (int)index_.size();
+}
+
+
+// View a page in place (indexes pages up to it, if needed)
+Frame_View Stack_Reader::Frame(int index)
+{
+	Frame_View view;
+	memset(&view, 0, sizeof(view));
+	while (((int)index_.size() <= index) && Index_Next_Page()) {}
+	if ((index < 0) || (index >= (int)index_.size())) { return view; }
+
+	const Stack_Index_Entry& page = index_[index];
+	view.data = (page.data_offset >= 0) ? (const void*)(data_ + page.data_offset) : NULL;
+	view.width = page.width;
+	view.height = page.height;
+	view.bytes_per_sample = page.bytes_per_sample;
+	view.sample_format = page.sample_format;
+	view.samples_per_pixel = page.samples_per_pixel;
+	return view;
+}
+
+
+// Copy a plane of a page as float (volts, uint16 pages are scaled with the calibration in the image description)
+bool Stack_Reader::Frame_To_Float(int index, int plane, float* frame)
+{
+	Frame_View view = Frame(index);
+	if ((view.data == NULL) || (plane >= view.samples_per_pixel)) { return false; }
+
+	int num_pixels = view.width * view.height;
+	const unsigned char* source = (const unsigned char*)view.data + ((size_t)plane * num_pixels * view.bytes_per_sample);
+	if ((view.bytes_per_sample == 4) && (view.sample_format == 3))
+	{
+		memcpy(frame, source, num_pixels * sizeof(float));
+	}
+	else if ((view.bytes_per_sample == 2) && (view.sample_format == 3))
+	{
+		const unsigned short* samples = (const unsigned short*)source;
+		for (int i = 0; i < num_pixels; i++)
+		{
+			frame[i] = Half_To_Float(samples[i]);
+		}
+	}
+	else if (view.bytes_per_sample == 2)
+	{
+		const unsigned short* samples = (const unsigned short*)source;
+		for (int i = 0; i < num_pixels; i++)
+		{
+			frame[i] = (float)((samples[i] * scale_) + offset_);
+		}
+	}
+	else if (view.bytes_per_sample == 1)
+	{
+		for (int i = 0; i < num_pixels; i++)
+		{
+			frame[i] = (float)((source[i] * scale_) + offset_);
+		}
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+
+// Unmap file (saving a completed index)
+void Stack_Reader::Close()
+{
+	if (data_ != NULL)
+	{
+		if ((next_ifd_ == 0) && !index_loaded_ && !index_.empty())
+		{
+			Save_Index();
+		}
+#ifdef _WIN32
+		UnmapViewOfFile(data_);
+#else
+		munmap((void*)data_, size_);
+#endif
+		data_ = NULL;
+	}
+#ifdef _WIN32
+	if (mapping_ != NULL)
+	{
+		CloseHandle(mapping_);
+		mapping_ = NULL;
+	}
+	if (file_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file_);
+		file_ = INVALID_HANDLE_VALUE;
+	}
+#endif
+}
+
+
+// Index the next page (returns false when all pages are indexed)
+bool Stack_Reader::Index_Next_Page()
+{
+	if ((data_ == NULL) || (next_ifd_ == 0)) { return false; }
+
+	// Directory entries (a count that does not fit in the rest of the file ends the chain, the stack is corrupt)
+	long long ifd = next_ifd_;
+	int count_bytes = big_tiff_ ? 8 : 2;
+	int entry_bytes = big_tiff_ ? 20 : 12;
+	int next_bytes = big_tiff_ ? 8 : 4;
+	long long num_entries = Read_Unsigned(ifd, count_bytes);
+	long long entries = ifd + count_bytes;
+	if ((num_entries < 0) || (num_entries > ((size_ - entries - next_bytes) / entry_bytes)))
+	{
+		next_ifd_ = 0;
+		return false;
+	}
+
+	// Read the fields we need
+	Stack_Index_Entry page;
+	memset(&page, 0, sizeof(page));
+	page.data_offset = -1;
+	page.sample_format = 1;
+	page.samples_per_pixel = 1;
+	int bits_per_sample = 0;
+	int compression = 1;
+	int planar_config = 1;
+	bool tiled = false;
+	long long strip_offsets = 0;
+	long long strip_byte_counts = 0;
+	for (long long e = 0; e < num_entries; e++)
+	{
+		long long entry = entries + (e * entry_bytes);
+		switch ((int)Read_Unsigned(entry, 2))
+		{
+		case 256: page.width = (int)Entry_Value(entry, 0); break;
+		case 257: page.height = (int)Entry_Value(entry, 0); break;
+		case 258: bits_per_sample = (int)Entry_Value(entry, 0); break;
+		case 259: compression = (int)Entry_Value(entry, 0); break;
+		case 270: if (index_.empty()) { Read_Calibration(entry); } break;
+		case 273: strip_offsets = entry; break;
+		case 277: page.samples_per_pixel = (int)Entry_Value(entry, 0); break;
+		case 279: strip_byte_counts = entry; break;
+		case 284: planar_config = (int)Entry_Value(entry, 0); break;
+		case 322: tiled = true; break;
+		case 339: page.sample_format = (int)Entry_Value(entry, 0); break;
+		}
+	}
+	page.bytes_per_sample = bits_per_sample / 8;
+
+	// Next page (only forward and inside the file, so a cyclic or corrupt chain ends)
+	next_ifd_ = Read_Unsigned(entries + (num_entries * entry_bytes), next_bytes);
+	if ((next_ifd_ <= ifd) || (next_ifd_ >= size_)) { next_ifd_ = 0; }
+
+	// Can the page be viewed in place? (uncompressed, in strips that follow each other, one plane after another)
+	bool mappable = (compression == 1) && !tiled && (strip_offsets != 0) && (strip_byte_counts != 0) && ((bits_per_sample % 8) == 0);
+	mappable = mappable && ((page.samples_per_pixel == 1) || (planar_config == 2));
+	if (mappable)
+	{
+		long long num_strips = Read_Unsigned(strip_offsets + 4, big_tiff_ ? 8 : 4);
+		mappable = (num_strips > 0) && (num_strips <= (size_ / (big_tiff_ ? 8 : 4)));
+		long long first = Entry_Value(strip_offsets, 0);
+		long long expected = first;
+		for (long long s = 0; (s < num_strips) && mappable; s++)
+		{
+			mappable = (Entry_Value(strip_offsets, (int)s) == expected);
+			expected += Entry_Value(strip_byte_counts, (int)s);
+		}
+		long long page_bytes = (long long)page.width * page.height * page.samples_per_pixel * page.bytes_per_sample;
+		if (mappable && ((expected - first) >= page_bytes) && ((first + page_bytes) <= size_))
+		{
+			page.data_offset = first;
+		}
+	}
+
+	// Add to index
+	index_.push_back(page);
+	return true;
+}
+
+
+// Read a cached index (if it matches the stack)
+bool Stack_Reader::Load_Index()
+{
+	std::ifstream file(path_ + ".d2pidx", std::ios::binary);
+	if (!file.is_open()) { return false; }
+	Stack_Index_Header header;
+	file.read((char*)&header, sizeof(header));
+	if (!file || (strcmp(header.magic, "D2P_IX2") != 0) || (header.file_size != size_) || (header.write_time != write_time_) || (header.first_ifd != first_ifd_) || (header.num_pages <= 0))
+	{
+		return false;
+	}
+
+	// Every page has a directory (at least one entry) in the stack, so more pages than fit in it means the cache is corrupt
+	long long min_ifd_bytes = big_tiff_ ? (8 + 20 + 8) : (2 + 12 + 4);
+	if (header.num_pages > (size_ / min_ifd_bytes))
+	{
+		return false;
+	}
+	index_.resize((size_t)header.num_pages);
+	file.read((char*)index_.data(), index_.size() * sizeof(Stack_Index_Entry));
+	if (!file)
+	{
+		index_.clear();
+		return false;
+	}
+
+	// Mapped pages must lie inside the stack
+	for (size_t p = 0; p < index_.size(); p++)
+	{
+		const Stack_Index_Entry& page = index_[p];
+		long long page_bytes = (long long)page.width * page.height * page.samples_per_pixel * page.bytes_per_sample;
+		if ((page.data_offset >= 0) && ((page.width < 0) || (page.height < 0) || (page.samples_per_pixel < 0) || (page.bytes_per_sample < 0) || ((page.data_offset + page_bytes) > size_)))
+		{
+			index_.clear();
+			return false;
+		}
+	}
+
+	// Index the first page again (the calibration is not cached, it is read from the stack), a different page means the cache is stale
+	std::vector<Stack_Index_Entry> cached;
+	cached.swap(index_);
+	next_ifd_ = first_ifd_;
+	bool first_matches = Index_Next_Page() && (memcmp(&index_[0], &cached[0], sizeof(Stack_Index_Entry)) == 0);
+	if (!first_matches)
+	{
+		index_.clear();
+		offset_ = 0.0;
+		scale_ = 1.0;
+		return false;
+	}
+	index_.swap(cached);
+	next_ifd_ = 0;
+	index_loaded_ = true;
+	return true;
+}
+
+
+// Cache the complete index next to the stack (ignored if the folder is read only)
+void Stack_Reader::Save_Index()
+{
+	std::ofstream file(path_ + ".d2pidx", std::ios::binary);
+	if (!file.is_open()) { return; }
+	Stack_Index_Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "D2P_IX2", 8);
+	header.file_size = size_;
+	header.write_time = write_time_;
+	header.first_ifd = first_ifd_;
+	header.num_pages = (long long)index_.size();
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)index_.data(), index_.size() * sizeof(Stack_Index_Entry));
+}
+
+
+// Read a little endian unsigned value (0 beyond the end of the file)
+long long Stack_Reader::Read_Unsigned(long long offset, int bytes)
+{
+	if ((offset < 0) || ((offset + bytes) > size_)) { return 0; }
+	unsigned long long value = 0;
+	for (int b = bytes - 1; b >= 0; b--)
+	{
+		value = (value << 8) | data_[offset + b];
+	}
+	return (long long)value;
+}
+
+
+// Read an element of a directory entry's (integer) value, stored in the entry if it fits
+long long Stack_Reader::Entry_Value(long long entry, int element)
+{
+	int type = (int)Read_Unsigned(entry + 2, 2);
+	long long count = Read_Unsigned(entry + 4, big_tiff_ ? 8 : 4);
+	int type_bytes = ((type == 3) || (type == 8)) ? 2 : (((type == 16) || (type == 17) || (type == 18)) ? 8 : (((type == 1) || (type == 2) || (type == 6) || (type == 7)) ? 1 : 4));
+	long long value_field = entry + (big_tiff_ ? 12 : 8);
+	long long base = ((count * type_bytes) <= (big_tiff_ ? 8 : 4)) ? value_field : Read_Unsigned(value_field, big_tiff_ ? 8 : 4);
+	return Read_Unsigned(base + ((long long)element * type_bytes), type_bytes);
+}
+
+
+// Read the uint16 calibration written by the Writer (volts = value * scale + offset)
+void Stack_Reader::Read_Calibration(long long entry)
+{
+	long long count = Read_Unsigned(entry + 4, big_tiff_ ? 8 : 4);
+	long long value_field = entry + (big_tiff_ ? 12 : 8);
+	long long base = (count <= (big_tiff_ ? 8 : 4)) ? value_field : Read_Unsigned(value_field, big_tiff_ ? 8 : 4);
+	if ((base < 0) || ((base + count) > size_)) { return; }
+	std::string description((const char*)&data_[base], (size_t)count);
+	size_t position = description.find("dreo2p_offset=");
+	if (position != std::string::npos) { offset_ = strtod(description.c_str() + position + 14, NULL); }
+	position = description.find("dreo2p_scale=");
+	if (position != std::string::npos) { scale_ = strtod(description.c_str() + position + 13, NULL); }
+}
+
+
+// Convert IEEE half precision to float
+float Stack_Reader::Half_To_Float(unsigned short value)
+{
+	unsigned int sign = (unsigned int)(value & 0x8000) << 16;
+	unsigned int exponent = (value >> 10) & 0x1f;
+	unsigned int mantissa = value & 0x3ff;
+	unsigned int bits;
+	if (exponent == 0x1f)
+	{
+		// Infinity and NaN
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		// Normal
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa == 0)
+	{
+		// Zero
+		bits = sign;
+	}
+	else
+	{
+		// Subnormal (normalize)
+		exponent = 113;
+		while ((mantissa & 0x400) == 0)
+		{
+			mantissa <<= 1;
+			exponent--;
+		}
+		bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+// FIN
@@ -0,0 +1,80 @@
+// Dreo2P Stack Reader Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <vector>
+#include <cstring>
+
+// Include platform headers (memory mapped files)
+#ifdef _WIN32
+#include "windows.h"
+#endif
+
+// A page of a stack, viewed in place in the mapped file (data is NULL if the page is not stored uncompressed and contiguous)
+struct Frame_View
+{
+	const void*	data;
+	int			width;
+	int			height;
+	int			bytes_per_sample;
+	int			sample_format;			// TIFF sample format (1 = uint, 3 = IEEE float)
+	int			samples_per_pixel;		// Planes follow each other (planar pages)
+};
+
+// Index entry of a page (cached next to the stack)
+struct Stack_Index_Entry
+{
+	long long	data_offset;			// Offset of the (contiguous, uncompressed) page data, -1 if not mappable
+	int			width;
+	int			height;
+	int			bytes_per_sample;
+	int			sample_format;
+	int			samples_per_pixel;
+	int			reserved;
+};
+
+class Stack_Reader
+{
+public:
+	// Constructors
+	Stack_Reader(std::string path);
+
+	// Destructors
+	~Stack_Reader();
+
+	// Public Methods
+	bool		Is_Open();
+	int			Num_Frames();											// Indexes every page (unless cached)
+	Frame_View	Frame(int index);										// Indexes pages up to index (lazily)
+	bool		Frame_To_Float(int index, int plane, float* frame);		// Copy a plane in volts (uint16 pages are calibrated)
+	void		Close();
+
+private:
+	// Private Members (mapped file)
+	std::string				path_;
+	const unsigned char*	data_ = NULL;
+	long long				size_ = 0;
+	long long				write_time_ = 0;		// Modification time (validates the cached index)
+#ifdef _WIN32
+	HANDLE					file_ = INVALID_HANDLE_VALUE;
+	HANDLE					mapping_ = NULL;
+#endif
+
+	// Private Members (TIFF structure)
+	bool					big_tiff_ = false;
+	long long				first_ifd_ = 0;
+	long long				next_ifd_ = 0;			// Next page to index (0 = all indexed)
+	std::vector<Stack_Index_Entry>	index_;
+	bool					index_loaded_ = false;	// Index read from cache
+	double					offset_ = 0.0;			// uint16 calibration (from the image description)
+	double					scale_ = 1.0;
+
+	// Private Methods
+	bool		Index_Next_Page();
+	bool		Load_Index();
+	void		Save_Index();
+	long long	Read_Unsigned(long long offset, int bytes);
+	long long	Entry_Value(long long entry, int element);
+	void		Read_Calibration(long long entry);
+	static float	Half_To_Float(unsigned short value);
+};
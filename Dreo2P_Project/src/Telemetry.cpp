@@ -0,0 +1,83 @@
+// Dreo2P Telemetry Class (source)
+#include "Telemetry.h"
+
+// Constructor
+Telemetry::Telemetry(std::string name, bool publish)
+{
+	// Map the block (create it if publishing)
+	memory_ = new Shared_Memory(name, publish ? sizeof(Telemetry_Block) : 0, publish);
+	if (!memory_->Is_Open() || (memory_->Size() < sizeof(Telemetry_Block))) { return; }
+	block_ = (Telemetry_Block*)memory_->Data();
+
+	// Publisher writes the header (counters start at zero)
+	if (publish)
+	{
+		block_->sequence.store(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		memset(&block_->counters, 0, sizeof(Telemetry_Counters));
+		memcpy(block_->magic, "D2P_TEL", 8);
+		block_->version = telemetry_version;
+		block_->size = (int)sizeof(Telemetry_Block);
+		block_->sequence.store(2, std::memory_order_release);
+	}
+}
+
+
+// Destructor
+Telemetry::~Telemetry()
+{
+	Close();
+}
+
+
+// Is the block mapped?
+bool Telemetry::Is_Open()
+{
+	return (block_ != NULL);
+}
+
+
+// Write new counters (readers retry while the sequence is odd or changes)
+void Telemetry::Publish(const Telemetry_Counters& counters)
+{
+	if (block_ == NULL) { return; }
+	unsigned int sequence = block_->sequence.load(std::memory_order_relaxed);
+	block_->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(&block_->counters, &counters, sizeof(Telemetry_Counters));
+	block_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+
+// Read a consistent copy of the counters
+bool Telemetry::Read(Telemetry_Counters* counters)
+{
+	if ((block_ == NULL) || (strcmp(block_->magic, "D2P_TEL") != 0) || (block_->version != telemetry_version)) { return false; }
+	for (int attempt = 0; attempt < 1000; attempt++)
+	{
+		unsigned int before = block_->sequence.load(std::memory_order_acquire);
+		if ((before & 1) == 0)
+		{
+			memcpy(counters, &block_->counters, sizeof(Telemetry_Counters));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (block_->sequence.load(std::memory_order_relaxed) == before) { return true; }
+		}
+		std::this_thread::yield();
+	}
+	return false;
+}
+
+
+// Unmap the block
+void Telemetry::Close()
+{
+	if (memory_ != NULL)
+	{
+		memory_->Close();
+		delete memory_;
+		memory_ = NULL;
+	}
+	block_ = NULL;
+}
+
+// FIN
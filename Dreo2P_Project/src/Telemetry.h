@@ -0,0 +1,68 @@
+// Dreo2P Telemetry Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+// Inlcude Local Headers
+#include "Shared_Memory.h"
+
+// Telemetry layout version (increment when Telemetry_Counters changes)
+static const int	telemetry_version = 2;
+
+// Live counters of a scanner
+struct Telemetry_Counters
+{
+	int			scanning;				// 1 while a scan group is running
+	int			frame_width;
+	int			frame_height;
+	int			frames_to_average;
+	long long	frames_completed;		// Frames binned (every frame of each averaged group)
+	long long	groups_completed;		// Averaged frames completed
+	double		frame_rate;				// Frames per second (current scan group)
+	double		pixel_rate;				// Binned pixels per second (current scan group)
+	long long	scans_read;				// Scans (one sample per channel) read from the source
+	long long	backlog_scans;			// Scans waiting in the source (device buffer)
+	long long	lines_dropped;			// Scan lines lost to source overflow
+	long long	raw_scans_dropped;		// Scans not recorded (raw recorder full)
+	int			disk_queue_depth;		// Frames waiting for the writer
+	int			write_errors;			// Blocks or pages the writer failed to write
+	long long	frames_written;
+	long long	frames_dropped;			// Frames not saved (writer queue full)
+	double		timestamp;				// Seconds since the scanner was initialized
+};
+
+// Shared memory block (a seqlock: sequence is odd while the counters are being written)
+struct Telemetry_Block
+{
+	char					magic[8];	// "D2P_TEL"
+	int						version;
+	int						size;		// Bytes (of the whole block)
+	std::atomic<unsigned int>	sequence;
+	unsigned int			reserved;
+	Telemetry_Counters		counters;
+};
+
+// Publishes (scanner) or reads (monitors) the telemetry block
+class Telemetry
+{
+public:
+	// Constructors
+	Telemetry(std::string name, bool publish);
+
+	// Destructors
+	~Telemetry();
+
+	// Public Methods
+	bool	Is_Open();
+	void	Publish(const Telemetry_Counters& counters);		// Single writer
+	bool	Read(Telemetry_Counters* counters);					// Consistent snapshot (false if not published or a different version)
+	void	Close();
+
+private:
+	// Private Members
+	Shared_Memory*		memory_ = NULL;
+	Telemetry_Block*	block_ = NULL;
+};
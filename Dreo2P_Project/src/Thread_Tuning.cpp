@@ -0,0 +1,87 @@
+// Dreo2P Thread Tuning Class (source)
+#include "Thread_Tuning.h"
+
+#ifdef _WIN32
+// Set priority and affinity of a thread handle
+static bool Apply_Handle(HANDLE thread, Thread_Options options)
+{
+	bool applied = true;
+
+	// Priority (within the process priority class)
+	int priority = THREAD_PRIORITY_NORMAL;
+	if (options.priority == PRIORITY_HIGH) { priority = THREAD_PRIORITY_HIGHEST; }
+	if (options.priority == PRIORITY_REALTIME) { priority = THREAD_PRIORITY_TIME_CRITICAL; }
+	if (!SetThreadPriority(thread, priority)) { applied = false; }
+
+	// Affinity (a single logical CPU of the first 64)
+	if ((options.cpu >= 0) && (options.cpu < 64))
+	{
+		if (SetThreadAffinityMask(thread, (DWORD_PTR)1 << options.cpu) == 0) { applied = false; }
+	}
+	return applied;
+}
+#else
+// Set scheduling policy and affinity of a pthread
+static bool Apply_Handle(pthread_t thread, Thread_Options options)
+{
+	bool applied = true;
+
+	// Scheduling policy and priority
+	struct sched_param param;
+	int policy = SCHED_OTHER;
+	param.sched_priority = 0;
+	if (options.priority == PRIORITY_HIGH)
+	{
+		policy = SCHED_RR;
+		param.sched_priority = sched_get_priority_min(SCHED_RR);
+	}
+	if (options.priority == PRIORITY_REALTIME)
+	{
+		policy = SCHED_FIFO;
+		param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+	}
+	if (pthread_setschedparam(thread, policy, &param) != 0) { applied = false; }
+
+	// Affinity (a single logical CPU)
+	if ((options.cpu >= 0) && (options.cpu < CPU_SETSIZE))
+	{
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(options.cpu, &cpus);
+		if (pthread_setaffinity_np(thread, sizeof(cpus), &cpus) != 0) { applied = false; }
+	}
+	return applied;
+}
+#endif
+
+
+// Tune a running thread (nothing to do if it is not running)
+bool Thread_Tuning::Apply(std::thread& thread, Thread_Options options)
+{
+	if (!thread.joinable()) { return false; }
+#ifdef _WIN32
+	return Apply_Handle((HANDLE)thread.native_handle(), options);
+#else
+	return Apply_Handle(thread.native_handle(), options);
+#endif
+}
+
+
+// Tune the calling thread
+bool Thread_Tuning::Apply_Current(Thread_Options options)
+{
+#ifdef _WIN32
+	return Apply_Handle(GetCurrentThread(), options);
+#else
+	return Apply_Handle(pthread_self(), options);
+#endif
+}
+
+
+// Default scheduling? (normal priority, any CPU)
+bool Thread_Tuning::Is_Default(Thread_Options options)
+{
+	return (options.priority == PRIORITY_NORMAL) && (options.cpu < 0);
+}
+
+// FIN
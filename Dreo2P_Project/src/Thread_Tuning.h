@@ -0,0 +1,46 @@
+// Dreo2P Thread Tuning Class (header)
+#pragma once
+// Include STD headers
+#include <thread>
+
+// Include platform headers (thread priorities and affinity masks on Windows, POSIX scheduling policies on Linux)
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pipeline threads that can be tuned
+enum Pipeline_Thread
+{
+	THREAD_SCANNER,			// Reads, bins and publishes (the thread that must keep up with the device)
+	THREAD_DISPLAY,			// Uploads and renders the display frame
+	THREAD_WRITER			// Writes queued frames to disk
+};
+static const int	num_pipeline_threads = 3;
+
+// Scheduling class of a thread
+enum Thread_Priority
+{
+	PRIORITY_NORMAL,		// Default (time shared)
+	PRIORITY_HIGH,			// Windows: highest thread priority, Linux: round robin real-time (lowest real-time priority)
+	PRIORITY_REALTIME		// Windows: time critical, Linux: FIFO real-time (preempts everything but the kernel's own threads)
+};
+
+// Scheduling of a pipeline thread
+struct Thread_Options
+{
+	int		priority = PRIORITY_NORMAL;
+	int		cpu = -1;				// Pin to this logical CPU (-1 = any)
+};
+
+// Applies priorities and CPU affinity (real-time classes need privileges: Linux CAP_SYS_NICE or an rtprio limit)
+class Thread_Tuning
+{
+public:
+	// Public Methods
+	static bool		Apply(std::thread& thread, Thread_Options options);		// A running thread (false if refused)
+	static bool		Apply_Current(Thread_Options options);					// The calling thread
+	static bool		Is_Default(Thread_Options options);						// Nothing to apply
+};
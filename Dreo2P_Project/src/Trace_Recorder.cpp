@@ -0,0 +1,100 @@
+// Dreo2P Trace Recorder Class (source)
+#include "Trace_Recorder.h"
+
+// Constructor (trace buffer)
+Trace_Buffer::Trace_Buffer(std::string thread_name, int capacity)
+{
+	thread_name_ = thread_name;
+	events_.resize(capacity);
+}
+
+
+// Number of recorded events
+int Trace_Buffer::Num_Events()
+{
+	return count_.load(std::memory_order_acquire);
+}
+
+
+// Number of events dropped (buffer full)
+int Trace_Buffer::Num_Dropped()
+{
+	return dropped_;
+}
+
+
+// A recorded event
+const Trace_Event& Trace_Buffer::Event(int index)
+{
+	return events_[index];
+}
+
+
+// Name of the recording thread
+std::string Trace_Buffer::Thread_Name()
+{
+	return thread_name_;
+}
+
+
+// Constructor
+Trace_Recorder::Trace_Recorder(std::string path, int events_per_thread)
+{
+	path_ = path;
+	events_per_thread_ = events_per_thread;
+	start_ = Tsc_Clock::Now();
+}
+
+
+// Destructor
+Trace_Recorder::~Trace_Recorder()
+{
+	for (size_t b = 0; b < buffers_.size(); b++)
+	{
+		delete buffers_[b];
+	}
+}
+
+
+// Allocate an event buffer for a thread
+Trace_Buffer* Trace_Recorder::Register_Thread(std::string thread_name)
+{
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+	Trace_Buffer* buffer = new Trace_Buffer(thread_name, events_per_thread_);
+	buffers_.push_back(buffer);
+	return buffer;
+}
+
+
+// Save all events as complete ("X") events, one trace thread per buffer (microseconds since the recorder started)
+bool Trace_Recorder::Save()
+{
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+	std::ofstream file(path_);
+	if (!file.is_open()) { return false; }
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Dreo2P\"}}";
+	char line[256];
+	for (size_t b = 0; b < buffers_.size(); b++)
+	{
+		// Name the thread (and note dropped events)
+		Trace_Buffer* buffer = buffers_[b];
+		int tid = (int)b + 1;
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\"" << buffer->Thread_Name() << "\",\"dropped\":" << buffer->Num_Dropped() << "}}";
+
+		// Events
+		int num_events = buffer->Num_Events();
+		for (int e = 0; e < num_events; e++)
+		{
+			const Trace_Event& event = buffer->Event(e);
+			double begin = Tsc_Clock::To_Microseconds((double)(long long)(event.begin - start_));
+			double duration = Tsc_Clock::To_Microseconds((double)(event.end - event.begin));
+			snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", event.name, tid, begin, duration);
+			file << line;
+		}
+	}
+	file << "\n]}\n";
+	return (bool)file;
+}
+
+// FIN
@@ -0,0 +1,78 @@
+// Dreo2P Trace Recorder Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <fstream>
+#include <cstdio>
+
+// Inlcude Local Headers
+#include "Tsc_Clock.h"
+
+// A timed event (complete: begin and end timestamps)
+struct Trace_Event
+{
+	const char*			name;		// Static string
+	unsigned long long	begin;		// Ticks (Tsc_Clock)
+	unsigned long long	end;
+};
+
+// Events of one thread (preallocated, written only by that thread, events are dropped when full)
+class Trace_Buffer
+{
+public:
+	// Constructors
+	Trace_Buffer(std::string thread_name, int capacity);
+
+	// Public Methods
+	void		Record(const char* name, unsigned long long begin, unsigned long long end);
+	int			Num_Events();
+	int			Num_Dropped();
+	const Trace_Event&	Event(int index);
+	std::string	Thread_Name();
+
+private:
+	// Private Members
+	std::string				thread_name_;
+	std::vector<Trace_Event>	events_;
+	std::atomic<int>		count_ = 0;
+	std::atomic<int>		dropped_ = 0;
+};
+
+// Collects per thread event buffers and saves them as a Chrome trace (chrome://tracing, Perfetto)
+class Trace_Recorder
+{
+public:
+	// Constructors
+	Trace_Recorder(std::string path, int events_per_thread);
+
+	// Destructors
+	~Trace_Recorder();
+
+	// Public Methods
+	Trace_Buffer*	Register_Thread(std::string thread_name);	// Buffer for the calling (or a new) thread
+	bool			Save();										// Write the JSON trace (once recording threads have stopped)
+
+private:
+	// Private Members
+	std::string					path_;
+	int							events_per_thread_;
+	unsigned long long			start_;							// Trace time origin (ticks)
+	std::vector<Trace_Buffer*>	buffers_;
+	std::mutex					buffers_mutex_;
+};
+
+// Record an event (inline, called around every traced stage)
+inline void Trace_Buffer::Record(const char* name, unsigned long long begin, unsigned long long end)
+{
+	int count = count_.load(std::memory_order_relaxed);
+	if (count == (int)events_.size())
+	{
+		dropped_.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	events_[count] = { name, begin, end };
+	count_.store(count + 1, std::memory_order_release);
+}
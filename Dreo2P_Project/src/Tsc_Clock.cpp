@@ -0,0 +1,34 @@
+// Dreo2P TSC Clock Class (source)
+#include "Tsc_Clock.h"
+
+// Measure the time stamp counter rate (once, over 50 ms)
+static double Calibrate()
+{
+#ifdef DREO2P_TSC
+	auto start_time = std::chrono::steady_clock::now();
+	unsigned long long start_ticks = Tsc_Clock::Now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	unsigned long long end_ticks = Tsc_Clock::Now();
+	double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+	return (double)(end_ticks - start_ticks) / microseconds;
+#else
+	return 1000.0;
+#endif
+}
+
+
+// Ticks per microsecond
+double Tsc_Clock::Ticks_Per_Microsecond()
+{
+	static double ticks_per_microsecond = Calibrate();
+	return ticks_per_microsecond;
+}
+
+
+// Convert a tick count to microseconds
+double Tsc_Clock::To_Microseconds(double ticks)
+{
+	return ticks / Ticks_Per_Microsecond();
+}
+
+// FIN
@@ -0,0 +1,34 @@
+// Dreo2P TSC Clock Class (header)
+#pragma once
+// Include STD headers
+#include <chrono>
+#include <thread>
+
+// Include time stamp counter intrinsics (x86), other platforms use the steady clock
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define DREO2P_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DREO2P_TSC
+#endif
+
+// Cheap timestamps for instrumenting hot paths (ticks, converted to time only when reported)
+class Tsc_Clock
+{
+public:
+	// Public Methods
+	static unsigned long long	Now();
+	static double	Ticks_Per_Microsecond();			// Calibrated against the steady clock on first use
+	static double	To_Microseconds(double ticks);
+};
+
+// Read the time stamp counter (inline, called around every stage)
+inline unsigned long long Tsc_Clock::Now()
+{
+#ifdef DREO2P_TSC
+	return __rdtsc();
+#else
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
@@ -0,0 +1,160 @@
+// Dreo2P Worker Pool Class (source)
+#include "Worker_Pool.h"
+
+// Constructor
+Worker_Pool::Worker_Pool(int num_threads)
+{
+	// Use one thread per core by default
+	if (num_threads <= 0)
+	{
+		num_threads = (int)std::thread::hardware_concurrency();
+	}
+
+	// Start worker threads (the thread calling Run is the first worker)
+	active_ = true;
+	for (int i = 1; i < num_threads; i++)
+	{
+		worker_threads_.push_back(std::thread(&Worker_Pool::Worker_Thread_Function, this));
+	}
+}
+
+
+// Destructor
+Worker_Pool::~Worker_Pool()
+{
+	Close();
+}
+
+
+// Worker thread function
+void Worker_Pool::Worker_Thread_Function()
+{
+	unsigned int seen_generation = 0;
+	while (true)
+	{
+		// Wait for a new batch of tasks (a batch that has already finished, task cleared, is not joined)
+		const std::function<void(int)>* task;
+		int num_tasks;
+		unsigned int generation;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			start_signal_.wait(lock, [&] { return (generation_ != seen_generation) || !active_; });
+			if (!active_) { break; }
+			seen_generation = generation_;
+			if (task_ == NULL) { continue; }
+			task = task_;
+			num_tasks = num_tasks_;
+			generation = generation_;
+			busy_workers_++;
+		}
+
+		// Run tasks of this batch until none are left
+		int t;
+		while (Claim_Task(generation, num_tasks, &t))
+		{
+			(*task)(t);
+		}
+
+		// Leave batch
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			busy_workers_--;
+		}
+		done_signal_.notify_one();
+	}
+}
+
+
+// Run a batch of tasks in parallel (and wait for them to finish)
+void Worker_Pool::Run(int num_tasks, const std::function<void(int)>& task)
+{
+	// Publish batch
+	unsigned int generation;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		task_ = &task;
+		num_tasks_ = num_tasks;
+		generation_++;
+		generation = generation_;
+		next_task_ = (unsigned long long)generation << 32;
+	}
+	start_signal_.notify_all();
+
+	// Run tasks on this thread as well
+	int t;
+	while (Claim_Task(generation, num_tasks, &t))
+	{
+		task(t);
+	}
+
+	// Wait until all workers that joined the batch have left it
+	std::unique_lock<std::mutex> lock(mutex_);
+	done_signal_.wait(lock, [this] { return busy_workers_ == 0; });
+	task_ = NULL;
+}
+
+
+// Claim the next task of a batch (false once the batch has no tasks left, or a later batch has started)
+bool Worker_Pool::Claim_Task(unsigned int generation, int num_tasks, int* task)
+{
+	unsigned long long next = next_task_.load();
+	while (true)
+	{
+		if (((unsigned int)(next >> 32) != generation) || ((int)(next & 0xFFFFFFFF) >= num_tasks)) { return false; }
+		if (next_task_.compare_exchange_weak(next, next + 1))
+		{
+			*task = (int)(next & 0xFFFFFFFF);
+			return true;
+		}
+	}
+}
+
+
+// Number of threads running tasks (including the caller)
+int Worker_Pool::Num_Threads()
+{
+	return (int)worker_threads_.size() + 1;
+}
+
+
+// CPU time used by the worker threads (seconds)
+double Worker_Pool::Cpu_Seconds()
+{
+	double seconds = 0.0;
+	for (size_t i = 0; i < worker_threads_.size(); i++)
+	{
+		seconds += Cpu_Meter::Thread_Seconds(worker_threads_[i]);
+	}
+	return seconds;
+}
+
+
+// Tune the worker threads (the calling thread keeps its own scheduling)
+bool Worker_Pool::Set_Thread_Options(Thread_Options options)
+{
+	bool applied = true;
+	for (size_t i = 0; i < worker_threads_.size(); i++)
+	{
+		if (!Thread_Tuning::Apply(worker_threads_[i], options)) { applied = false; }
+	}
+	return applied;
+}
+
+
+// Stop worker threads
+void Worker_Pool::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!active_) { return; }
+		active_ = false;
+	}
+	start_signal_.notify_all();
+	for (size_t i = 0; i < worker_threads_.size(); i++)
+	{
+		worker_threads_[i].join();
+	}
+	worker_threads_.clear();
+}
+
+// FIN
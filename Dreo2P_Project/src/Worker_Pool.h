@@ -0,0 +1,51 @@
+// Dreo2P Worker Pool Class (header)
+#pragma once
+// Include STD headers
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+// Inlcude Local Headers
+#include "Thread_Tuning.h"
+#include "Cpu_Meter.h"
+
+class Worker_Pool
+{
+public:
+	// Constructors
+	Worker_Pool(int num_threads);
+
+	// Destructors
+	~Worker_Pool();
+
+	// Public Methods
+	void	Run(int num_tasks, const std::function<void(int)>& task);	// Run task(0...num_tasks-1) in parallel, returns when all are done
+	int		Num_Threads();
+	double	Cpu_Seconds();		// CPU time used by the worker threads (not the threads calling Run)
+	bool	Set_Thread_Options(Thread_Options options);		// Priority and CPU of every worker thread (false if refused)
+	void	Close();
+
+private:
+	// Private Members (current batch of tasks, NULL task = no batch to join)
+	const std::function<void(int)>*	task_ = NULL;
+	int					num_tasks_ = 0;
+	std::atomic<unsigned long long>	next_task_ = 0;		// Batch generation (high 32 bits) and next task (low 32 bits), so a task is only claimed from its own batch
+	unsigned int		generation_ = 0;
+	int					busy_workers_ = 0;
+	std::mutex			mutex_;
+	std::condition_variable	start_signal_;
+	std::condition_variable	done_signal_;
+
+	// Private Members (worker threads, the calling thread also runs tasks)
+	std::vector<std::thread>	worker_threads_;
+	bool				active_ = false;
+
+	// Private Methods
+	bool		Claim_Task(unsigned int generation, int num_tasks, int* task);
+
+	// Thread Function
+	void		Worker_Thread_Function();
+};
@@ -0,0 +1,858 @@
+// Dreo2P Writer Class (source)
+#include "Writer.h"
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#ifdef DREO2P_USE_ZLIB
+#include "zlib.h"
+#endif
+#ifdef DREO2P_USE_ZSTD
+#include "zstd.h"
+#endif
+
+// Classic TIFF files use 32-bit offsets (keep a margin for directories)
+static const double	classic_tiff_limit = 4294967295.0 * 0.98;
+
+// Frames larger than this (in pixels) are tiled when the layout is automatic
+static const int	large_frame_pixels = 1024 * 1024;
+
+// Target size of a compressed strip (small enough to spread a frame across all cores)
+static const int	strip_bytes = 64 * 1024;
+
+// Constructor
+Writer::Writer(std::string path, int frame_width, int frame_height, int num_chans, int total_pages, int projected_pages, Writer_Options options)
+{
+	// Set frame size and stack parameters
+	frame_width_ = frame_width;
+	frame_height_ = frame_height;
+	total_pages_ = total_pages;
+	queue_length_ = options.queue_length;
+	tile_size_ = options.tile_size;
+
+	// Set on-disk sample format (only uint16 is scaled)
+	sample_format_ = options.sample_format;
+	bytes_per_sample_ = (sample_format_ == TIFF_SAMPLE_FLOAT32) ? 4 : 2;
+	offset_ = (sample_format_ == TIFF_SAMPLE_UINT16) ? options.offset : 0.0;
+	scale_ = (sample_format_ == TIFF_SAMPLE_UINT16) ? options.scale : 1.0;
+
+	// Select saved channels (at least one)
+	channel_layout_ = options.channel_layout;
+	num_chans_ = std::min(std::max(num_chans, 1), writer_max_chans);
+	for (int c = 0; c < num_chans_; c++)
+	{
+		if (options.channel_mask & (1 << c)) { channels_.push_back(c); }
+	}
+	if (channels_.empty()) { channels_.push_back(0); }
+	num_saved_ = (int)channels_.size();
+	if (num_saved_ == 1) { channel_layout_ = TIFF_CHANNELS_SEPARATE; }
+	pages_per_frame_ = (channel_layout_ == TIFF_CHANNELS_PAGES) ? num_saved_ : 1;
+
+	// Describe calibration on every page (ImageJ reads cf=0 as volts = c0 + c1 * value), and the channel order of a single stack
+	const char* format_names[3] = { "float32", "uint16", "float16" };
+	char description[512];
+	char hyperstack[256] = "";
+	if (channel_layout_ == TIFF_CHANNELS_PAGES)
+	{
+		if (total_pages_ > 0)
+		{
+			snprintf(hyperstack, sizeof(hyperstack), "images=%d\nchannels=%d\nframes=%d\nhyperstack=true\nmode=grayscale\n", total_pages_ * num_saved_, num_saved_, total_pages_);
+		}
+		else
+		{
+			snprintf(hyperstack, sizeof(hyperstack), "channels=%d\nhyperstack=true\nmode=grayscale\n", num_saved_);
+		}
+	}
+	if (sample_format_ == TIFF_SAMPLE_UINT16)
+	{
+		snprintf(description, sizeof(description), "ImageJ=1.11a\n%scf=0\nc0=%.17g\nc1=%.17g\nvunit=V\ndreo2p_format=%s\ndreo2p_offset=%.17g\ndreo2p_scale=%.17g\n",
+			hyperstack, offset_, scale_, format_names[sample_format_], offset_, scale_);
+	}
+	else if (channel_layout_ == TIFF_CHANNELS_PAGES)
+	{
+		snprintf(description, sizeof(description), "ImageJ=1.11a\n%sdreo2p_format=%s\ndreo2p_offset=%.17g\ndreo2p_scale=%.17g\n", hyperstack, format_names[sample_format_], offset_, scale_);
+	}
+	else
+	{
+		snprintf(description, sizeof(description), "dreo2p_format=%s\ndreo2p_offset=%.17g\ndreo2p_scale=%.17g\n", format_names[sample_format_], offset_, scale_);
+	}
+	description_ = std::string(description);
+	if (channel_layout_ != TIFF_CHANNELS_SEPARATE)
+	{
+		description_ += "dreo2p_channels=";
+		for (int i = 0; i < num_saved_; i++)
+		{
+			description_ += std::to_string(channels_[i]) + ((i < (num_saved_ - 1)) ? "," : "\n");
+		}
+	}
+
+	// Select file format (an unbounded recording, projected_pages = 0, could exceed any classic limit)
+	int channels_per_file = (channel_layout_ == TIFF_CHANNELS_SEPARATE) ? 1 : num_saved_;
+	double projected_bytes = (double)projected_pages * channels_per_file * (((double)frame_width_ * frame_height_ * bytes_per_sample_) + 1024.0);
+	if (options.format == TIFF_FORMAT_AUTO)
+	{
+		big_tiff_ = (projected_pages <= 0) || (projected_bytes > classic_tiff_limit);
+	}
+	else
+	{
+		big_tiff_ = (options.format == TIFF_FORMAT_BIG);
+	}
+
+	// Select page layout
+	if (options.layout == TIFF_LAYOUT_AUTO)
+	{
+		tiled_ = (frame_width_ * frame_height_) > large_frame_pixels;
+	}
+	else
+	{
+		tiled_ = (options.layout == TIFF_LAYOUT_TILES);
+	}
+
+	// Select compression (codecs missing from libtiff fall back: zstd -> deflate -> none)
+	bool zstd_available = false;
+#ifdef DREO2P_USE_ZSTD
+	zstd_available = (TIFFIsCODECConfigured(COMPRESSION_ZSTD) != 0);
+#endif
+	compression_level_ = options.compression_level;
+	switch (options.compression)
+	{
+	case TIFF_COMPRESSION_ZSTD:
+		if (zstd_available)
+		{
+			compression_ = COMPRESSION_ZSTD;
+			break;
+		}
+		// fall through (to deflate)
+	case TIFF_COMPRESSION_DEFLATE:
+		if (TIFFIsCODECConfigured(COMPRESSION_ADOBE_DEFLATE))
+		{
+			compression_ = COMPRESSION_ADOBE_DEFLATE;
+		}
+		break;
+	case TIFF_COMPRESSION_LZW:
+		if (TIFFIsCODECConfigured(COMPRESSION_LZW))
+		{
+			compression_ = COMPRESSION_LZW;
+		}
+		break;
+	default:
+		compression_ = COMPRESSION_NONE;
+	}
+	// Encode blocks in parallel with our own codec build (otherwise libtiff encodes deflate serially)
+#ifdef DREO2P_USE_ZLIB
+	parallel_codec_ = (compression_ == COMPRESSION_ADOBE_DEFLATE);
+#endif
+	parallel_codec_ = parallel_codec_ || (compression_ == COMPRESSION_ZSTD);
+	if (compression_ == COMPRESSION_NONE)
+	{
+		predictor_ = PREDICTOR_NONE;
+	}
+	else
+	{
+		predictor_ = (sample_format_ == TIFF_SAMPLE_UINT16) ? PREDICTOR_HORIZONTAL : PREDICTOR_FLOATINGPOINT;
+	}
+
+	// Split frames into blocks (one strip per frame, unless compressing or tiled)
+	int row_bytes;
+	if (tiled_)
+	{
+		rows_per_strip_ = frame_height_;
+		num_blocks_ = ((frame_width_ + tile_size_ - 1) / tile_size_) * ((frame_height_ + tile_size_ - 1) / tile_size_);
+		block_bytes_ = tile_size_ * tile_size_ * bytes_per_sample_;
+		row_bytes = tile_size_ * bytes_per_sample_;
+	}
+	else
+	{
+		rows_per_strip_ = (compression_ == COMPRESSION_NONE) ? frame_height_ : std::max(1, strip_bytes / (frame_width_ * bytes_per_sample_));
+		num_blocks_ = (frame_height_ + rows_per_strip_ - 1) / rows_per_strip_;
+		block_bytes_ = rows_per_strip_ * frame_width_ * bytes_per_sample_;
+		row_bytes = frame_width_ * bytes_per_sample_;
+	}
+
+	// Make space for block data (one block per channel, or every block of every saved channel when compressing in parallel)
+	int num_block_buffers = parallel_codec_ ? (num_saved_ * num_blocks_) : num_saved_;
+	raw_blocks_.resize(num_block_buffers);
+	row_buffers_.resize(num_block_buffers);
+	for (int i = 0; i < num_block_buffers; i++)
+	{
+		raw_blocks_[i].resize(block_bytes_);
+		row_buffers_[i].resize(row_bytes);
+	}
+	if (parallel_codec_)
+	{
+		size_t bound = block_bytes_;
+#ifdef DREO2P_USE_ZLIB
+		bound = std::max(bound, (size_t)compressBound(block_bytes_));
+#endif
+#ifdef DREO2P_USE_ZSTD
+		bound = std::max(bound, ZSTD_compressBound(block_bytes_));
+#endif
+		compressed_blocks_.resize(num_block_buffers);
+		compressed_sizes_.resize(num_block_buffers);
+		for (int i = 0; i < num_block_buffers; i++)
+		{
+			compressed_blocks_[i].resize(bound);
+		}
+	}
+
+	// Make space for frames converted to the on-disk sample format
+	if (sample_format_ != TIFF_SAMPLE_FLOAT32)
+	{
+		converted_frames_.resize(num_saved_);
+		for (int i = 0; i < num_saved_; i++)
+		{
+			converted_frames_[i].resize(frame_width_ * frame_height_ * bytes_per_sample_);
+		}
+	}
+
+	// Start compression threads (every block in parallel, or one thread per channel file when libtiff encodes)
+	if (parallel_codec_)
+	{
+		compression_pool_ = new Worker_Pool(options.compression_threads);
+	}
+	else if ((compression_ != COMPRESSION_NONE) && (channel_layout_ == TIFF_CHANNELS_SEPARATE) && (num_saved_ > 1))
+	{
+		compression_pool_ = new Worker_Pool((options.compression_threads > 0) ? std::min(options.compression_threads, num_saved_) : num_saved_);
+	}
+
+	// Make space for queued frames of the saved channels (allocated once, reused for every frame)
+	queue_.resize(queue_length_);
+	for (int i = 0; i < queue_length_; i++)
+	{
+		queue_[i].resize((size_t)frame_width_ * frame_height_ * num_saved_);
+	}
+	queue_refs_.resize(queue_length_);
+	extra_samples_.resize(std::max(1, num_saved_ - 1), EXTRASAMPLE_UNSPECIFIED);
+	queue_pools_.resize(queue_length_, NULL);
+
+	// Open TIFF files (one per saved channel, or a single stack)
+	const char* mode = big_tiff_ ? "w8" : "w";
+	if (channel_layout_ == TIFF_CHANNELS_SEPARATE)
+	{
+		for (int i = 0; i < num_saved_; i++)
+		{
+			std::string channel_path = path + "_" + std::to_string(channels_[i]) + ".tiff";
+			files_.push_back(TIFFOpen(channel_path.c_str(), mode));
+		}
+	}
+	else
+	{
+		std::string stack_path = path + std::string(".tiff");
+		files_.push_back(TIFFOpen(stack_path.c_str(), mode));
+	}
+
+	// Start the writer thread
+	active_ = true;
+	writer_thread_ = std::thread(&Writer::Writer_Thread_Function, this);
+}
+
+
+// Destructor
+Writer::~Writer()
+{
+}
+
+
+// Writer thread function
+void Writer::Writer_Thread_Function()
+{
+	// Write queued frames until closed (and the queue is empty)
+	while (true)
+	{
+		// Wait for a queued frame
+		int slot;
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex_);
+			queue_signal_.wait(lock, [this] { return (queue_count_ > 0) || !active_; });
+			if (queue_count_ == 0) { break; }
+			slot = queue_head_;
+		}
+
+		// Save frames to TIFF stacks (slot is not touched by the scanner until released)
+		unsigned long long write_start = Tsc_Clock::Now();
+		const float* saved_frames[writer_max_chans];
+		size_t pixels = (size_t)frame_width_ * frame_height_;
+		for (int i = 0; i < num_saved_; i++)
+		{
+			if (queue_pools_[slot] != NULL)
+			{
+				saved_frames[i] = queue_refs_[slot].data + channels_[i] * pixels;
+			}
+			else
+			{
+				saved_frames[i] = queue_[slot].data() + i * pixels;
+			}
+		}
+		Save_Frames(saved_frames);
+		current_page_++;
+		frames_written_++;
+		unsigned long long write_end = Tsc_Clock::Now();
+		Latency_Histogram* write_latency = write_latency_;
+		Trace_Buffer* write_trace = write_trace_;
+		if (write_latency != NULL) { write_latency->Record(write_end - write_start); }
+		if (write_trace != NULL) { write_trace->Record("Write", write_start, write_end); }
+
+		// Release slot (and its pool frame)
+		if (queue_pools_[slot] != NULL)
+		{
+			queue_pools_[slot]->Release(queue_refs_[slot]);
+			queue_pools_[slot] = NULL;
+		}
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex_);
+			queue_head_ = (queue_head_ + 1) % queue_length_;
+			queue_count_--;
+		}
+	}
+}
+
+
+// Queue (averaged) frames for writing, returns false (and drops the frames) if the queue is full
+bool Writer::Write_Frames(const float* frames)
+{
+	// Find a free slot
+	int slot;
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex_);
+		if (queue_count_ == queue_length_)
+		{
+			frames_dropped_++;
+			return false;
+		}
+		slot = (queue_head_ + queue_count_) % queue_length_;
+	}
+
+	// Copy frames of the saved channels into slot
+	queue_pools_[slot] = NULL;
+	size_t pixels = (size_t)frame_width_ * frame_height_;
+	for (int i = 0; i < num_saved_; i++)
+	{
+		const float* frame = frames + channels_[i] * pixels;
+		std::copy(frame, frame + pixels, queue_[slot].begin() + i * pixels);
+	}
+
+	// Publish slot to writer thread
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex_);
+		queue_count_++;
+	}
+	queue_signal_.notify_one();
+	return true;
+}
+
+
+// Queue a pool frame for writing without copying (the writer keeps a reference until it is saved), returns false (and drops the frame) if the queue is full
+bool Writer::Write_Frame(Frame_Pool* pool, const Frame_Ref& frame)
+{
+	// Find a free slot
+	int slot;
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex_);
+		if (queue_count_ == queue_length_)
+		{
+			frames_dropped_++;
+			return false;
+		}
+		slot = (queue_head_ + queue_count_) % queue_length_;
+	}
+
+	// Keep the frame
+	pool->Add_Ref(frame);
+	queue_refs_[slot] = frame;
+	queue_pools_[slot] = pool;
+
+	// Publish slot to writer thread
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex_);
+		queue_count_++;
+	}
+	queue_signal_.notify_one();
+	return true;
+}
+
+
+// Time each frame written to disk (on the writer thread)
+void Writer::Set_Latency_Histogram(Latency_Histogram* histogram)
+{
+	write_latency_ = histogram;
+}
+
+
+// Trace each frame written to disk (the buffer is only written by the writer thread)
+void Writer::Set_Trace(Trace_Buffer* trace)
+{
+	write_trace_ = trace;
+}
+
+
+// Tune the writer thread
+bool Writer::Set_Thread_Options(Thread_Options options)
+{
+	return Thread_Tuning::Apply(writer_thread_, options);
+}
+
+
+// CPU time used by the writer thread and its compression threads (seconds)
+double Writer::Cpu_Seconds()
+{
+	return Cpu_Meter::Thread_Seconds(writer_thread_) + ((compression_pool_ != NULL) ? compression_pool_->Cpu_Seconds() : 0.0);
+}
+
+
+// Number of frames waiting to be written
+int Writer::Queue_Depth()
+{
+	std::lock_guard<std::mutex> lock(queue_mutex_);
+	return queue_count_;
+}
+
+
+// Number of frames written to disk
+int Writer::Frames_Written()
+{
+	return frames_written_;
+}
+
+
+// Number of frames dropped (queue full)
+int Writer::Frames_Dropped()
+{
+	return frames_dropped_;
+}
+
+
+// Number of blocks and pages libtiff failed to write (the stack is incomplete)
+int Writer::Write_Errors()
+{
+	return write_errors_;
+}
+
+
+// Is the stack written as BigTIFF?
+bool Writer::Is_Big_Tiff()
+{
+	return big_tiff_;
+}
+
+
+// Is the stack written in tiles?
+bool Writer::Is_Tiled()
+{
+	return tiled_;
+}
+
+
+// TIFF compression scheme in use (after fallbacks)
+int Writer::Compression()
+{
+	return compression_;
+}
+
+
+// Number of saved channels
+int Writer::Num_Saved_Channels()
+{
+	return num_saved_;
+}
+
+
+// Stop thread (after writing all queued frames) and close TIFF files
+void Writer::Close()
+{
+	// End writer thread (if active)
+	if (active_)
+	{
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex_);
+			active_ = false;
+		}
+		queue_signal_.notify_one();
+		writer_thread_.join();
+	}
+
+	// Stop compression threads
+	if (compression_pool_ != NULL)
+	{
+		compression_pool_->Close();
+		delete compression_pool_;
+		compression_pool_ = NULL;
+	}
+
+	// Close TIFF files
+	for (int f = 0; f < (int)files_.size(); f++)
+	{
+		if (files_[f] != NULL)
+		{
+			TIFFClose(files_[f]);
+			files_[f] = NULL;
+		}
+	}
+}
+
+
+// Save a frame of each saved channel (a page per channel, or the planes of a single page)
+void Writer::Save_Frames(const float* const* saved_frames)
+{
+	const unsigned char* frames[writer_max_chans];
+
+	// Convert frames to the on-disk sample format
+	for (int i = 0; i < num_saved_; i++)
+	{
+		frames[i] = (const unsigned char*)saved_frames[i];
+		if (sample_format_ != TIFF_SAMPLE_FLOAT32)
+		{
+			Convert_Frame(saved_frames[i], converted_frames_[i].data());
+			frames[i] = converted_frames_[i].data();
+		}
+	}
+
+	if (parallel_codec_)
+	{
+		// Compress every block of every saved channel in parallel
+		auto compress = [&](int task)
+		{
+			Compress_Block(frames[task / num_blocks_], task % num_blocks_, task);
+		};
+		compression_pool_->Run(num_saved_ * num_blocks_, std::ref(compress));	// By reference (a task never allocates)
+
+		// Write compressed blocks (in order, a block that failed to compress is encoded again by libtiff)
+		for (int i = 0; i < num_saved_; i++)
+		{
+			TIFF* file = File_For(i);
+			if (Starts_Page(i)) { Set_Tiff_Fields(file, Page_Number(i)); }
+			for (int b = 0; b < num_blocks_; b++)
+			{
+				int task = (i * num_blocks_) + b;
+				if (compressed_sizes_[task] > 0)
+				{
+					Write_Block(file, Block_Index(i, b), compressed_blocks_[task].data(), compressed_sizes_[task], true);
+				}
+				else
+				{
+					int row_samples;
+					int rows = Gather_Block(frames[i], b, raw_blocks_[task].data(), &row_samples);
+					Write_Block(file, Block_Index(i, b), raw_blocks_[task].data(), (size_t)rows * row_samples * bytes_per_sample_, false);
+				}
+			}
+			if (Ends_Page(i) && !TIFFWriteDirectory(file)) { write_errors_++; }
+		}
+	}
+	else if ((compression_pool_ != NULL) && (channel_layout_ == TIFF_CHANNELS_SEPARATE))
+	{
+		// Encode each channel's stack on its own thread (libtiff encodes a file serially)
+		auto encode = [&](int i)
+		{
+			Save_Frame_to_1ch_Tiff(i, frames[i], raw_blocks_[i].data());
+		};
+		compression_pool_->Run(num_saved_, std::ref(encode));
+	}
+	else
+	{
+		for (int i = 0; i < num_saved_; i++)
+		{
+			Save_Frame_to_1ch_Tiff(i, frames[i], raw_blocks_[i].data());
+		}
+	}
+}
+
+
+// Save a grayscale (single channel) data frame, already in the on-disk sample format, to its TIFF file (as a page, or a plane of the current page)
+void Writer::Save_Frame_to_1ch_Tiff(int channel, const unsigned char* data, unsigned char* block_data)
+{
+	// Set Tiff parameters
+	TIFF* tiff_file = File_For(channel);
+	if (Starts_Page(channel))
+	{
+		Set_Tiff_Fields(tiff_file, Page_Number(channel));
+	}
+
+	// Write frame data (libtiff encodes blocks in place, so copy them out of the frame first)
+	if (tiled_ || (compression_ != COMPRESSION_NONE))
+	{
+		int row_samples;
+		for (int b = 0; b < num_blocks_; b++)
+		{
+			int rows = Gather_Block(data, b, block_data, &row_samples);
+			Write_Block(tiff_file, Block_Index(channel, b), block_data, (size_t)rows*row_samples*bytes_per_sample_, false);
+		}
+	}
+	else
+	{
+		Write_Block(tiff_file, Block_Index(channel, 0), (void*)data, (size_t)frame_width_*frame_height_*bytes_per_sample_, false);
+	}
+	if (Ends_Page(channel) && !TIFFWriteDirectory(tiff_file)) { write_errors_++; }
+}
+
+
+// Write a strip or tile, already compressed (raw) or encoded by libtiff, counting failed writes
+void Writer::Write_Block(TIFF* tiff_file, int index, void* data, size_t bytes, bool raw)
+{
+	tmsize_t written;
+	if (tiled_)
+	{
+		written = raw ? TIFFWriteRawTile(tiff_file, index, data, (tmsize_t)bytes) : TIFFWriteEncodedTile(tiff_file, index, data, (tmsize_t)bytes);
+	}
+	else
+	{
+		written = raw ? TIFFWriteRawStrip(tiff_file, index, data, (tmsize_t)bytes) : TIFFWriteEncodedStrip(tiff_file, index, data, (tmsize_t)bytes);
+	}
+	if (written < 0) { write_errors_++; }
+}
+
+
+// Set TIFF directory fields for the next page
+void Writer::Set_Tiff_Fields(TIFF *tiff_file, int page)
+{
+	TIFFSetField(tiff_file, TIFFTAG_IMAGEWIDTH, frame_width_);
+	TIFFSetField(tiff_file, TIFFTAG_IMAGELENGTH, frame_height_);
+	if (tiled_)
+	{
+		TIFFSetField(tiff_file, TIFFTAG_TILEWIDTH, tile_size_);
+		TIFFSetField(tiff_file, TIFFTAG_TILELENGTH, tile_size_);
+	}
+	else
+	{
+		TIFFSetField(tiff_file, TIFFTAG_ROWSPERSTRIP, rows_per_strip_);
+	}
+	TIFFSetField(tiff_file, TIFFTAG_BITSPERSAMPLE, 8 * bytes_per_sample_);
+	TIFFSetField(tiff_file, TIFFTAG_SAMPLEFORMAT, (sample_format_ == TIFF_SAMPLE_UINT16) ? SAMPLEFORMAT_UINT : SAMPLEFORMAT_IEEEFP);
+	TIFFSetField(tiff_file, TIFFTAG_IMAGEDESCRIPTION, description_.c_str());
+	TIFFSetField(tiff_file, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+	TIFFSetField(tiff_file, TIFFTAG_COMPRESSION, compression_);
+	if (compression_ != COMPRESSION_NONE)
+	{
+		TIFFSetField(tiff_file, TIFFTAG_PREDICTOR, predictor_);
+	}
+	TIFFSetField(tiff_file, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+	TIFFSetField(tiff_file, TIFFTAG_FILLORDER, FILLORDER_MSB2LSB);
+	if (channel_layout_ == TIFF_CHANNELS_PLANAR)
+	{
+		// One plane per saved channel (the planes after the first are unspecified extra samples)
+		TIFFSetField(tiff_file, TIFFTAG_SAMPLESPERPIXEL, num_saved_);
+		TIFFSetField(tiff_file, TIFFTAG_EXTRASAMPLES, num_saved_ - 1, extra_samples_.data());
+		TIFFSetField(tiff_file, TIFFTAG_PLANARCONFIG, PLANARCONFIG_SEPARATE);
+	}
+	else
+	{
+		TIFFSetField(tiff_file, TIFFTAG_SAMPLESPERPIXEL, 1);
+		TIFFSetField(tiff_file, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+	}
+	TIFFSetField(tiff_file, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
+	TIFFSetField(tiff_file, TIFFTAG_PAGENUMBER, page, total_pages_ * pages_per_frame_);
+}
+
+
+// TIFF file of a saved channel
+TIFF* Writer::File_For(int channel)
+{
+	return (channel_layout_ == TIFF_CHANNELS_SEPARATE) ? files_[channel] : files_[0];
+}
+
+
+// Page number of a saved channel's current frame (channels are interleaved in a single stack of pages)
+int Writer::Page_Number(int channel)
+{
+	return (current_page_ * pages_per_frame_) + ((channel_layout_ == TIFF_CHANNELS_PAGES) ? channel : 0);
+}
+
+
+// Strip (or tile) number of a block of a saved channel (planes follow each other in a planar page)
+int Writer::Block_Index(int channel, int block)
+{
+	return (channel_layout_ == TIFF_CHANNELS_PLANAR) ? ((channel * num_blocks_) + block) : block;
+}
+
+
+// Does a saved channel start a new page?
+bool Writer::Starts_Page(int channel)
+{
+	return (channel_layout_ != TIFF_CHANNELS_PLANAR) || (channel == 0);
+}
+
+
+// Does a saved channel complete a page?
+bool Writer::Ends_Page(int channel)
+{
+	return (channel_layout_ != TIFF_CHANNELS_PLANAR) || (channel == (num_saved_ - 1));
+}
+
+
+// Convert a float32 frame (volts) to the on-disk sample format
+void Writer::Convert_Frame(const float* frame, unsigned char* data)
+{
+	unsigned short* samples = (unsigned short*)data;
+	int num_pixels = frame_width_ * frame_height_;
+	if (sample_format_ == TIFF_SAMPLE_UINT16)
+	{
+		// Scale, round and clamp to the uint16 range (NaN is stored as 0, the offset)
+		double inverse_scale = 1.0 / scale_;
+		for (int i = 0; i < num_pixels; i++)
+		{
+			double value = ((frame[i] - offset_) * inverse_scale) + 0.5;
+			if (std::isnan(value)) { value = 0.0; }
+			value = std::min(std::max(value, 0.0), 65535.0);
+			samples[i] = (unsigned short)value;
+		}
+	}
+	else
+	{
+		for (int i = 0; i < num_pixels; i++)
+		{
+			samples[i] = Float_To_Half(frame[i]);
+		}
+	}
+}
+
+
+// Copy a block (strip or zero padded tile) out of a frame, returns the number of rows
+int Writer::Gather_Block(const unsigned char* data, int block, unsigned char* block_data, int* row_samples)
+{
+	if (tiled_)
+	{
+		// Locate tile
+		int tiles_across = (frame_width_ + tile_size_ - 1) / tile_size_;
+		int tx = (block % tiles_across) * tile_size_;
+		int ty = (block / tiles_across) * tile_size_;
+		int tile_width = std::min(tile_size_, frame_width_ - tx);
+		int tile_height = std::min(tile_size_, frame_height_ - ty);
+
+		// Copy tile rows from frame (edge tiles are zero padded)
+		std::fill(block_data, block_data + block_bytes_, 0);
+		for (int row = 0; row < tile_height; row++)
+		{
+			const unsigned char* src = &data[(((ty + row) * frame_width_) + tx) * bytes_per_sample_];
+			std::copy(src, src + (tile_width * bytes_per_sample_), &block_data[row * tile_size_ * bytes_per_sample_]);
+		}
+		*row_samples = tile_size_;
+		return tile_size_;
+	}
+	else
+	{
+		// Copy strip rows from frame (the last strip may be short)
+		int first_row = block * rows_per_strip_;
+		int rows = std::min(rows_per_strip_, frame_height_ - first_row);
+		const unsigned char* src = &data[first_row * frame_width_ * bytes_per_sample_];
+		std::copy(src, src + (rows * frame_width_ * bytes_per_sample_), block_data);
+		*row_samples = frame_width_;
+		return rows;
+	}
+}
+
+
+// Compress a block (runs on a compression thread, each task has its own buffers)
+void Writer::Compress_Block(const unsigned char* data, int block, int task)
+{
+	// Gather block and apply predictor (row by row)
+	int row_samples;
+	unsigned char* raw = raw_blocks_[task].data();
+	int rows = Gather_Block(data, block, raw, &row_samples);
+	int row_bytes = row_samples * bytes_per_sample_;
+	for (int r = 0; r < rows; r++)
+	{
+		Apply_Predictor(&raw[r * row_bytes], row_samples, row_buffers_[task].data());
+	}
+
+	// Compress (size 0 = failed, the block is then encoded by libtiff)
+	size_t raw_size = rows * row_bytes;
+	compressed_sizes_[task] = 0;
+#ifdef DREO2P_USE_ZSTD
+	if (compression_ == COMPRESSION_ZSTD)
+	{
+		size_t compressed_size = ZSTD_compress(compressed_blocks_[task].data(), compressed_blocks_[task].size(), raw, raw_size, compression_level_);
+		if (!ZSTD_isError(compressed_size)) { compressed_sizes_[task] = compressed_size; }
+		return;
+	}
+#endif
+#ifdef DREO2P_USE_ZLIB
+	uLongf compressed_size = (uLongf)compressed_blocks_[task].size();
+	if (compress2(compressed_blocks_[task].data(), &compressed_size, raw, (uLong)raw_size, compression_level_) == Z_OK)
+	{
+		compressed_sizes_[task] = compressed_size;
+	}
+#endif
+}
+
+
+// Apply the TIFF predictor to a row
+void Writer::Apply_Predictor(unsigned char* row, int samples, unsigned char* row_buffer)
+{
+	// Horizontal predictor (uint16 sample differences)
+	if (predictor_ == PREDICTOR_HORIZONTAL)
+	{
+		unsigned short* words = (unsigned short*)row;
+		for (int i = samples - 1; i > 0; i--)
+		{
+			words[i] = (unsigned short)(words[i] - words[i - 1]);
+		}
+		return;
+	}
+
+	// Floating point predictor: split samples into byte planes, most significant first (little endian host)...
+	int bytes_per_sample = bytes_per_sample_;
+	std::copy(row, row + (samples * bytes_per_sample), row_buffer);
+	for (int i = 0; i < samples; i++)
+	{
+		for (int b = 0; b < bytes_per_sample; b++)
+		{
+			row[((bytes_per_sample - b - 1) * samples) + i] = row_buffer[(bytes_per_sample * i) + b];
+		}
+	}
+
+	// ...then horizontal byte differencing
+	for (int i = (samples * bytes_per_sample) - 1; i > 0; i--)
+	{
+		row[i] = (unsigned char)(row[i] - row[i - 1]);
+	}
+}
+
+
+// Convert a float to IEEE half precision (round to nearest even)
+unsigned short Writer::Float_To_Half(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	unsigned int sign = (bits >> 16) & 0x8000;
+	int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+	unsigned int mantissa = bits & 0x7fffff;
+
+	// Infinity and NaN
+	if (((bits >> 23) & 0xff) == 0xff)
+	{
+		return (unsigned short)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+	}
+
+	// Overflow (to infinity)
+	if (exponent >= 31)
+	{
+		return (unsigned short)(sign | 0x7c00);
+	}
+
+	// Subnormal (or underflow to zero)
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return (unsigned short)sign;
+		}
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		unsigned int half = mantissa >> shift;
+		unsigned int remainder = mantissa & ((1u << shift) - 1);
+		unsigned int halfway = 1u << (shift - 1);
+		if ((remainder > halfway) || ((remainder == halfway) && (half & 1)))
+		{
+			half++;
+		}
+		return (unsigned short)(sign | half);
+	}
+
+	// Normal (rounding may carry into the exponent, which is still correct)
+	unsigned int half = sign | ((unsigned int)exponent << 10) | (mantissa >> 13);
+	unsigned int remainder = mantissa & 0x1fff;
+	if ((remainder > 0x1000) || ((remainder == 0x1000) && (half & 1)))
+	{
+		half++;
+	}
+	return (unsigned short)half;
+}
+
+// FIN
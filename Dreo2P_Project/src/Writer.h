@@ -0,0 +1,186 @@
+// Dreo2P Writer Class (header)
+#pragma once
+// Include STD headers
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+// Include Local Headers
+#include "tiffio.h"
+#include "Worker_Pool.h"
+#include "Latency_Histogram.h"
+#include "Trace_Recorder.h"
+#include "Frame_Pool.h"
+#include "Thread_Tuning.h"
+
+// TIFF file formats
+enum Tiff_Format
+{
+	TIFF_FORMAT_AUTO,		// Classic, unless the projected stack exceeds 4 GB (or is unbounded)
+	TIFF_FORMAT_CLASSIC,	// Classic TIFF (32-bit offsets, 4 GB limit)
+	TIFF_FORMAT_BIG			// BigTIFF (64-bit offsets)
+};
+
+// TIFF page layouts
+enum Tiff_Layout
+{
+	TIFF_LAYOUT_AUTO,		// Strips, unless frames are large
+	TIFF_LAYOUT_STRIPS,		// One strip per frame
+	TIFF_LAYOUT_TILES		// Square tiles (fast random access to large frames)
+};
+
+// TIFF compression (lossless, with predictor)
+enum Tiff_Compression
+{
+	TIFF_COMPRESSION_NONE,
+	TIFF_COMPRESSION_LZW,		// Encoded by libtiff (one thread per channel file)
+	TIFF_COMPRESSION_DEFLATE,	// Encoded in parallel, one strip (or tile) per task (with DREO2P_USE_ZLIB, otherwise by libtiff)
+	TIFF_COMPRESSION_ZSTD		// Encoded in parallel (falls back to deflate if unavailable)
+};
+
+// On-disk sample formats
+enum Tiff_Sample_Format
+{
+	TIFF_SAMPLE_FLOAT32,	// 32-bit IEEE float (volts)
+	TIFF_SAMPLE_UINT16,		// 16-bit unsigned integer (volts = value * scale + offset)
+	TIFF_SAMPLE_FLOAT16		// 16-bit IEEE half float (volts)
+};
+
+// Channel layouts on disk
+enum Tiff_Channel_Layout
+{
+	TIFF_CHANNELS_SEPARATE,	// One stack per channel (path_0.tiff, path_1.tiff)
+	TIFF_CHANNELS_PAGES,	// Single stack, one page per channel per frame (ImageJ hyperstack)
+	TIFF_CHANNELS_PLANAR	// Single stack, one page per frame with a sample plane per channel
+};
+
+// Maximum number of acquired channels
+static const int	writer_max_chans = 8;
+
+// Writer options
+struct Writer_Options
+{
+	Tiff_Format			format = TIFF_FORMAT_AUTO;
+	Tiff_Layout			layout = TIFF_LAYOUT_AUTO;
+	int					tile_size = 256;		// Tile width and height (pixels, multiple of 16)
+	int					queue_length = 16;		// Number of frames that can wait to be written
+	Tiff_Compression	compression = TIFF_COMPRESSION_NONE;
+	int					compression_level = 1;	// Codec effort (1 = fastest)
+	int					compression_threads = 0;	// Number of compression threads (0 = one per core)
+	Tiff_Sample_Format	sample_format = TIFF_SAMPLE_FLOAT32;
+	double				offset = -10.0;				// uint16 calibration: volts at value 0
+	double				scale = 20.0 / 65535.0;		// uint16 calibration: volts per step (full +/-10 V input range)
+	Tiff_Channel_Layout	channel_layout = TIFF_CHANNELS_SEPARATE;
+	int					channel_mask = 0xFF;		// Channels to save (bit per channel, all acquired channels by default)
+};
+
+class Writer
+{
+public:
+	// Constructors
+	Writer(std::string path, int frame_width, int frame_height, int num_chans, int total_pages, int projected_pages, Writer_Options options);
+
+	// Destructors
+	~Writer();
+
+	// Public Methods
+	bool	Write_Frames(const float* frames);		// One frame per acquired channel (planes of width * height), copied into the queue
+	bool	Write_Frame(Frame_Pool* pool, const Frame_Ref& frame);	// A pool frame, queued by reference (released once saved)
+	int		Queue_Depth();
+	int		Frames_Written();
+	int		Frames_Dropped();
+	int		Write_Errors();
+	bool	Is_Big_Tiff();
+	bool	Is_Tiled();
+	int		Compression();
+	int		Num_Saved_Channels();
+	void	Set_Latency_Histogram(Latency_Histogram* histogram);	// Time each frame written to disk (NULL = none)
+	void	Set_Trace(Trace_Buffer* trace);							// Trace each frame written to disk (NULL = none)
+	bool	Set_Thread_Options(Thread_Options options);				// Priority and CPU of the writer thread (false if refused)
+	double	Cpu_Seconds();											// CPU time used by the writer and compression threads
+	void	Close();
+
+private:
+	// Private Members (TIFF)
+	std::vector<TIFF*>	files_;					// One per saved channel (separate layout), or a single stack
+	int					frame_width_;
+	int					frame_height_;
+	int					total_pages_;
+	int					current_page_ = 0;
+	bool				big_tiff_ = false;
+	bool				tiled_ = false;
+	int					tile_size_;
+
+	// Private Members (saved channels)
+	Tiff_Channel_Layout	channel_layout_;
+	int					num_chans_;				// Acquired channels
+	std::vector<int>	channels_;				// Saved channel numbers
+	int					num_saved_;
+	int					pages_per_frame_;
+
+	// Private Members (on-disk sample format)
+	Tiff_Sample_Format	sample_format_;
+	int					bytes_per_sample_;
+	double				offset_;
+	double				scale_;
+	std::string			description_;
+	std::vector<std::vector<unsigned char>>	converted_frames_;
+	std::vector<unsigned short>	extra_samples_;		// Planar layout: the planes after the first (unspecified)
+
+	// Private Members (compression, frames are split into blocks: strips or tiles)
+	int					compression_ = COMPRESSION_NONE;
+	int					compression_level_;
+	int					predictor_ = PREDICTOR_NONE;
+	bool				parallel_codec_ = false;
+	int					rows_per_strip_;
+	int					num_blocks_;
+	int					block_bytes_;
+	std::vector<std::vector<unsigned char>>	raw_blocks_;
+	std::vector<std::vector<unsigned char>>	compressed_blocks_;
+	std::vector<std::vector<unsigned char>>	row_buffers_;
+	std::vector<size_t>	compressed_sizes_;
+	Worker_Pool*		compression_pool_ = NULL;
+
+	// Private Members (frame queue, preallocated ring of frame slots, each holds the planes of the saved channels)
+	std::vector<std::vector<float>>	queue_;
+	std::vector<Frame_Ref>	queue_refs_;	// Frame referenced by each slot (slot -1 = copied into the slot)
+	std::vector<Frame_Pool*>	queue_pools_;
+	int					queue_length_;
+	int					queue_head_ = 0;
+	int					queue_count_ = 0;
+	std::mutex			queue_mutex_;
+	std::condition_variable	queue_signal_;
+	std::atomic<int>	frames_written_ = 0;
+	std::atomic<int>	frames_dropped_ = 0;
+	std::atomic<int>	write_errors_ = 0;
+	std::atomic<Latency_Histogram*>	write_latency_ = NULL;
+	std::atomic<Trace_Buffer*>		write_trace_ = NULL;
+
+	// Private Members (writer thread)
+	std::thread			writer_thread_;
+	std::atomic<bool>	active_ = false;
+
+	// Thread Function
+	void		Writer_Thread_Function();
+
+	// Private Methods
+	void		Save_Frames(const float* const* saved_frames);
+	void		Save_Frame_to_1ch_Tiff(int channel, const unsigned char* data, unsigned char* block_data);
+	void		Set_Tiff_Fields(TIFF *tiff_file, int page);
+	TIFF*		File_For(int channel);
+	int			Page_Number(int channel);
+	int			Block_Index(int channel, int block);
+	bool		Starts_Page(int channel);
+	bool		Ends_Page(int channel);
+	void		Convert_Frame(const float* frame, unsigned char* data);
+	int			Gather_Block(const unsigned char* data, int block, unsigned char* block_data, int* row_samples);
+	void		Compress_Block(const unsigned char* data, int block, int task);
+	void		Write_Block(TIFF* tiff_file, int index, void* data, size_t bytes, bool raw);
+	void		Apply_Predictor(unsigned char* row, int samples, unsigned char* row_buffer);
+	static unsigned short	Float_To_Half(float value);
+};